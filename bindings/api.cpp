@@ -1,12 +1,62 @@
 #include "api.h"
 #include "board.hpp"
+#include "evaluate.hpp"
 #include "search.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <cstddef>
 #include <array>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 #include <zobrist.hpp>
 #include <transposition.hpp>
 
+namespace {
+// Run fn(board, i) for every i in [0, n) on up to `threads` threads (all of the cores for threads <= 0). Indices are
+// handed out in chunks, so the workers don't fight over the counter, and each worker reuses one board throughout.
+template <typename F>
+void parallel_for(const int64_t n, int threads, F fn) {
+  if (threads <= 0) {
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  constexpr int64_t chunk = 256;
+  std::atomic<int64_t> next = 0;
+  auto worker = [&]() {
+    Board board;
+    for (int64_t start = next.fetch_add(chunk); start < n; start = next.fetch_add(chunk)) {
+      for (int64_t i = start; i < std::min(start + chunk, n); i++) {
+        fn(board, i);
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int64_t t = 1; t < std::min<int64_t>(threads, (n + chunk - 1) / chunk); t++) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &w : workers) {
+    w.join();
+  }
+}
+
+// Set up the board from the fen, quiesced if asked, and write its features. Throws if the fen can't be parsed.
+void encode(Board &board, const std::string &fen, char *features, char *white_to_play, const bool quiesce) {
+  board.fen_decode(fen);
+  if (quiesce) {
+    DenseBoard pos = Search::board_quiesce(board);
+    board.unpack(pos);
+  }
+  // Because these things are colourblind, we need to know who's turn it is *after* the quiescence search.
+  // For training, the the eval used as a label should be from the same perspective as the features.
+  *white_to_play = board.who_to_play() == WHITE ? 1 : 0;
+  board.byte_encode(reinterpret_cast<uint8_t *>(features));
+}
+} // namespace
+
 extern "C" {
 int init() {
   Bitboards::init();
@@ -24,21 +74,57 @@ int encode_features(char *fen, char *buffer, unsigned int buffer_size, char* whi
   if (fen == nullptr || buffer == nullptr) {
     return 2; // Error: null pointer
   }
-  const std::string fen_string(fen);
   auto board = Board();
-  board.fen_decode(fen_string);
-  if (quiece) {
-      DenseBoard pos = Search::board_quiesce(board);
-      board.unpack(pos);
+  encode(board, std::string(fen), buffer, white_to_play, quiece);
+  return 0; // Success
+}
+
+int evaluate_batch(const char **fens, int64_t n, float *out, int threads) {
+  if (n < 0) {
+    return 1; // Error: negative count
   }
-  // Because these things are colourblind, we need to know who's turn it is *after* the quiescence search.
-  // For training, the the eval used as a label should be from the same perspective as the features.
-  *white_to_play = board.who_to_play() == WHITE ? 1 : 0;
- auto dense_board = board.byte_encoded();
-  for (size_t i = 0; i < N_SQUARE; ++i) {
-    buffer[i] = dense_board[i];
+  if (fens == nullptr || out == nullptr) {
+    return 2; // Error: null pointer
   }
-  return 0; // Success
+  // All of the workers share the current network, which is only read.
+  std::atomic<bool> failed = false;
+  parallel_for(n, threads, [&](Board &board, const int64_t i) {
+    if (fens[i] == nullptr) {
+      out[i] = NAN;
+      failed = true;
+      return;
+    }
+    try {
+      board.fen_decode(std::string(fens[i]));
+      out[i] = Evaluation::network_eval(board) * Neural::LOGISTIC_SCALING;
+    } catch (const std::exception &) {
+      out[i] = NAN;
+      failed = true;
+    }
+  });
+  return failed ? 3 : 0; // Error: some FENs could not be parsed, their evals are NaN
+}
+
+int encode_features_batch(const char *fens, const int64_t *offsets, int64_t n, char *features, char *white_to_play,
+                          int quiece, int threads) {
+  if (n < 0) {
+    return 1; // Error: negative count
+  }
+  if (fens == nullptr || offsets == nullptr || features == nullptr || white_to_play == nullptr) {
+    return 2; // Error: null pointer
+  }
+  std::atomic<bool> failed = false;
+  parallel_for(n, threads, [&](Board &board, const int64_t i) {
+    const std::string fen(fens + offsets[i], offsets[i + 1] - offsets[i]);
+    try {
+      encode(board, fen, features + i * N_SQUARE, white_to_play + i, quiece);
+    } catch (const std::exception &) {
+      std::fill_n(features + i * N_SQUARE, N_SQUARE, 0);
+      white_to_play[i] = -1;
+      failed = true;
+    }
+  });
+  return failed ? 3 : 0; // Error: some FENs could not be parsed, their side to move is -1
 }
 
 } // extern "C"
\ No newline at end of file
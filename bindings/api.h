@@ -1,6 +1,8 @@
 #ifndef ADMETE_API_H
 #define ADMETE_API_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -10,6 +12,17 @@ int init();
 
 int encode_features(char* fen, char* buffer, unsigned int buffer_size, char* move_after, int quiece);
 
+// Evaluate n positions with the network on `threads` threads (all of the cores for threads <= 0). out[i] is the eval of
+// fens[i] in centipawns, from the side to move's point of view, or NaN if it is null or could not be parsed. Returns 3 if
+// any were NaN, and 1 for a negative n.
+int evaluate_batch(const char** fens, int64_t n, float* out, int threads);
+
+// encode_features for n FENs on `threads` threads. FEN i is fens[offsets[i]] up to fens[offsets[i + 1]], so there are
+// n + 1 offsets. Its 64 bytes go to features[64 * i] and its side to move to white_to_play[i], which is -1 (with zeroed
+// features) if it could not be parsed. Returns 3 if any could not be parsed, and 1 for a negative n.
+int encode_features_batch(const char* fens, const int64_t* offsets, int64_t n, char* features, char* white_to_play,
+                          int quiece, int threads);
+
 #ifdef __cplusplus
 }
 #endif
@@ -151,7 +151,7 @@ bool interposes(const Square origin, const Square target, const Square query) {
 void Board::initialise() {
     search_kings();
     update_checkers();
-    update_check_squares();
+    invalidate_lazy_info();
     hash_history[0] = Zobrist::hash(*this);
 
     for (int c = WHITE; c < N_COLOUR; c++) {
@@ -160,9 +160,77 @@ void Board::initialise() {
         }
     }
     _phase_material = Evaluation::count_phase_material(*this);
-    update_attacks();
     set_root();
+    _accumulator.use_weights_of(Neural::current_accumulator());
     _accumulator.initialise(*this);
+    accumulator_ply = ply_counter;
+}
+
+void Board::reload_network() {
+    // The accumulator can only unmake moves it was built after, so go back to the start of the game, rebuild it there
+    // and replay the moves. The history is kept, unlike setting the position up again from its fen.
+    const ply_t root = root_node_ply;
+    std::vector<Move> moves;
+    while (ply_counter > 0) {
+        const Move move = last_move();
+        moves.push_back(move);
+        if (move == NULL_MOVE) {
+            unmake_nullmove();
+        } else {
+            unmake_move(move);
+        }
+    }
+    _accumulator.use_weights_of(Neural::current_accumulator());
+    _accumulator.initialise(*this);
+    accumulator_ply = ply_counter;
+    for (auto it = moves.rbegin(); it != moves.rend(); it++) {
+        if (*it == NULL_MOVE) {
+            make_nullmove();
+        } else {
+            make_move(*it);
+        }
+    }
+    root_node_ply = root;
+}
+
+// Copy each member once, in particular the accumulator with its state stack and refresh table.
+Board::Board(const Board &other)
+    : occupied_bb(other.occupied_bb), colour_bb(other.colour_bb), piece_bb(other.piece_bb), whos_move(other.whos_move),
+      fullmove_counter(other.fullmove_counter), ply_counter(other.ply_counter), king_square(other.king_square),
+      aux_history(other.aux_history), hash_history(other.hash_history), root_node_ply(other.root_node_ply),
+      _phase_material(other._phase_material), _accumulator(other._accumulator),
+      accumulator_ply(other.accumulator_ply) {
+    for (int c = WHITE; c < N_COLOUR; c++) {
+        for (PieceType p = PAWN; p < N_PIECE; p++) {
+            piece_counts[c][p] = other.piece_counts[c][p];
+        }
+    }
+    // aux_info points into our own history, not the other board's.
+    aux_info = aux_history.data() + (other.aux_info - other.aux_history.data());
+}
+
+Board &Board::operator=(const Board &other) {
+    occupied_bb = other.occupied_bb;
+    colour_bb = other.colour_bb;
+    piece_bb = other.piece_bb;
+    for (int c = WHITE; c < N_COLOUR; c++) {
+        for (PieceType p = PAWN; p < N_PIECE; p++) {
+            piece_counts[c][p] = other.piece_counts[c][p];
+        }
+    }
+    whos_move = other.whos_move;
+    fullmove_counter = other.fullmove_counter;
+    ply_counter = other.ply_counter;
+    king_square = other.king_square;
+    aux_history = other.aux_history;
+    hash_history = other.hash_history;
+    root_node_ply = other.root_node_ply;
+    _phase_material = other._phase_material;
+    _accumulator = other._accumulator;
+    accumulator_ply = other.accumulator_ply;
+    // aux_info points into our own history, not the other board's.
+    aux_info = aux_history.data() + (other.aux_info - other.aux_history.data());
+    return *this;
 }
 
 bool Board::is_free(const Square target) const { return (occupied_bb & target) == 0; };
@@ -306,7 +374,7 @@ void Board::make_move(Move &move) {
 
     // Update the various data structures that are computed for the position
     update_checkers();
-    update_check_squares();
+    invalidate_lazy_info();
 
     assert(_phase_material == Evaluation::count_phase_material(*this));
 
@@ -316,11 +384,12 @@ void Board::make_move(Move &move) {
 
     assert(hash() == Zobrist::hash(*this));
 
+    // The accumulator picks the move up from here when it is next needed. Unless it has to be rebuilt for this position,
+    // which can't wait until later moves have been made.
     aux_info->last_move = move;
-
-    // Add this move into the NNUE accumulator
-    _accumulator.make_move(move, us);
-    update_attacks();
+    if (Neural::accumulator_t::needs_refresh(move, us)) {
+        update_accumulator();
+    }
 }
 
 void Board::unmake_move(const Move move) {
@@ -405,7 +474,11 @@ void Board::unmake_move(const Move move) {
 
     assert(_phase_material == Evaluation::count_phase_material(*this));
 
-    _accumulator.unmake_move(move, us);
+    // Only pop the move off the accumulator if it was ever added.
+    if (accumulator_ply > ply_counter) {
+        _accumulator.unmake_move();
+        accumulator_ply = ply_counter;
+    }
 }
 
 void Board::make_nullmove() {
@@ -429,14 +502,13 @@ void Board::make_nullmove() {
 
     // Update the various data structures that are computed for the position
     update_checkers();
-    update_check_squares();
+    invalidate_lazy_info();
 
     // Update the zorbist hash
     hash_history[ply_counter] = hash_history[ply_counter - 1] ^ Zobrist::nulldiff(us, last_ep_file);
     assert(hash() == Zobrist::hash(*this));
 
     aux_info->last_move = NULL_MOVE;
-    update_attacks();
 }
 
 void Board::unmake_nullmove() {
@@ -447,14 +519,35 @@ void Board::unmake_nullmove() {
     }
     ply_counter--;
     aux_info = &aux_history[ply_counter];
+    // A null move doesn't change the accumulator.
+    accumulator_ply = std::min(accumulator_ply, ply_counter);
 
     // Switch whos turn it is to play
     whos_move = ~whos_move;
 }
 
+void Board::update_accumulator() const {
+    while (accumulator_ply < ply_counter) {
+        accumulator_ply++;
+        const Move move = aux_history[accumulator_ply].last_move;
+        if (move != NULL_MOVE) {
+            // The side to move alternates, counting back from the current position.
+            const Colour mover = (ply_counter - accumulator_ply) % 2 == 0 ? ~whos_move : whos_move;
+            if (Neural::accumulator_t::needs_refresh(move, mover)) {
+                // Only ever the latest move, see make_move.
+                assert(accumulator_ply == ply_counter);
+                _accumulator.refresh(*this, move, mover);
+            } else {
+                _accumulator.make_move(move, mover);
+            }
+        }
+    }
+}
+
 Move Board::fetch_move(const std::string move_sting) {
     // Get the move object for a move from a uci string.
-    std::vector<Move> legal_moves = get_moves();
+    MoveList legal_moves;
+    get_moves(legal_moves);
     for (Move move : legal_moves) {
         if (move_sting == move.pretty()) {
             return move;
@@ -514,7 +607,7 @@ void Board::search_kings() {
 
 void Board::update_checkers() {
     // Looks in the current position if the king (of the player to move) is in check, and saves where those checks are.
-    // It also looks up what pieces are pinned, which is used in move generation.
+    // Nearly every node wants to know if it's in check, so unlike the pins this is done straight away.
     const Square origin = find_king(whos_move);
     const Colour us = whos_move;
     const Colour them = ~us;
@@ -523,9 +616,7 @@ void Board::update_checkers() {
     const Bitboard occ = pieces();
 
     const Bitboard ratk = rook_attacks(occ, origin);
-    const Bitboard rxray = rook_attacks(occ ^ (occ & ratk), origin);
     const Bitboard batk = bishop_attacks(occ, origin);
-    const Bitboard bxray = bishop_attacks(occ ^ (occ & batk), origin);
 
     Bitboard atk = Bitboards::pseudo_attacks(KNIGHT, origin) & pieces(them, KNIGHT);
     atk |= Bitboards::pawn_attacks(us, origin) & pieces(them, PAWN);
@@ -535,6 +626,19 @@ void Board::update_checkers() {
         aux_info->checkers[aux_info->number_checkers] = pop_lsb(&atk);
         aux_info->number_checkers++;
     }
+    aux_info->is_check = aux_info->number_checkers > 0;
+}
+
+void Board::update_pinned() const {
+    // Looks up what pieces are pinned to the king of the player to move, which is used in move generation.
+    const Square origin = find_king(whos_move);
+    const Colour us = whos_move;
+    const Colour them = ~us;
+
+    const Bitboard occ = pieces();
+
+    const Bitboard rxray = rook_attacks(occ ^ (occ & rook_attacks(occ, origin)), origin);
+    const Bitboard bxray = bishop_attacks(occ ^ (occ & bishop_attacks(occ, origin)), origin);
 
     aux_info->pinned = 0;
     Bitboard pinner = rxray & pieces(them, ROOK, QUEEN);
@@ -544,10 +648,10 @@ void Board::update_checkers() {
         Bitboard pinned = (Bitboards::between(origin, sq) & pieces(us));
         aux_info->pinned |= pinned;
     }
-    aux_info->is_check = aux_info->number_checkers > 0;
+    aux_info->pinned_valid = true;
 }
 
-void Board::update_check_squares() {
+void Board::update_check_squares() const {
     // Looks at what piece placements would put the enemy king in check. For instance, what squares a bishop could be on
     // and give check. Also looks at what pieces are blocking checks, such that if they moved they could cause a
     // discovered check.
@@ -580,6 +684,7 @@ void Board::update_check_squares() {
         blk |= pinned;
     }
     aux_info->blockers = blk;
+    aux_info->check_squares_valid = true;
 }
 
 bool Board::gives_check(const Move move) const {
@@ -771,7 +876,7 @@ void Board::flip() {
 
 zobrist_t Board::material_key() const { return Zobrist::material(*this); }
 
-void Board::update_attacks() {
+void Board::update_attacks() const {
     const Colour us = who_to_play();
     const Colour them = ~us;
     aux_info->attacked = Bitboards::pawn_attacks(them, pieces(them, PAWN));
@@ -784,25 +889,28 @@ void Board::update_attacks() {
         }
     }
     aux_info->attacked |= Bitboards::attacks<KING>(occ, find_king(them));
+    aux_info->attacked_valid = true;
     for (int i = 0; i < N_SQUARE; i++) {
         Square sq(i);
         assert(bool(aux_info->attacked & sq_to_bb(sq)) == test_attacked(*this, sq, us));
     }
 }
 
-std::array<uint8_t, N_SQUARE> Board::byte_encoded() {
-    bool flipped = false;
-    if (this->who_to_play() == BLACK) {
-        flipped = true;
-        this->flip();
-    }
+std::array<uint8_t, N_SQUARE> Board::byte_encoded() const {
+    std::array<uint8_t, N_SQUARE> dense_board;
+    byte_encode(dense_board.data());
+    return dense_board;
+}
+
+void Board::byte_encode(uint8_t *dense_board) const {
+    // The encoding is from the point of view of the side to move, as if the board were flipped when black is to move.
+    // Rather than flipping it (and reinitialising it twice), read each square from its mirror.
+    const Colour us = who_to_play();
     // dense format is 64 bytes, 0 is empty, 1-6 for white peices, 9-14 for black pieces. 8 will be a "black emtpy square", and should never happen.
-    std::array<uint8_t, 64> dense_board = {0};
     for (Square::square_t sq = 0; sq < N_SQUARE; sq++) {
-        Piece p = this->pieces(sq);
+        Piece p = this->pieces(Square(sq).relative(us));
         auto pt = p.get_piece();
-        auto c = p.get_colour();
-        auto cv = c == WHITE ? 0 : 8; // 0 for white, 8 for black
+        auto cv = p.get_colour() == us ? 0 : 8; // 0 for the side to move, 8 for the other
         if (pt == NO_PIECE) {
             dense_board[sq] = 0; // empty square
         } else {
@@ -810,7 +918,4 @@ std::array<uint8_t, N_SQUARE> Board::byte_encoded() {
             dense_board[sq] = (uint8_t)(pt + cv + 1);
         }
     }
-    // flip the board back
-    if (flipped) this->flip();
-    return dense_board;
 }
\ No newline at end of file
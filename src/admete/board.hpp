@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include <features.hpp>
+#include <netfile.hpp>
 #include <weights.hpp>
 
 struct DenseBoard {
@@ -15,6 +16,8 @@ struct DenseBoard {
 };
 
 // Information that is game history dependent, that would otherwise need to be encoded in a move.
+// The pins, check squares and attacks are only worked out the first time they are asked for in a position, a node that
+// returns before generating moves never pays for them. They stay valid until the next move is made.
 struct AuxilliaryInfo {
     // Holds the castling rights data, with bit flags set from CastlingRights enum.
     unsigned castling_rights;
@@ -36,6 +39,10 @@ struct AuxilliaryInfo {
     Bitboard blockers;
     // Squares that the *other* player is attacking, ignoring pins.
     Bitboard attacked;
+    // Which of the lazy fields have been filled in for this position.
+    bool pinned_valid = false;
+    bool check_squares_valid = false;
+    bool attacked_valid = false;
     // Move that brought us to this position.
     Move last_move = NULL_MOVE;
 };
@@ -45,6 +52,8 @@ class Board {
     void fen_decode(const std::string &fen);
     std::string fen_encode() const;
     void initialise();
+    // Switch the accumulator to the current network, keeping the moves that led to this position.
+    void reload_network();
     void initialise_starting_position() { fen_decode("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"); }
 
     DenseBoard pack() const {
@@ -71,6 +80,10 @@ class Board {
 
     Board(DenseBoard &db) { unpack(db); };
 
+    // Copies keep their own history, so a search thread can be given a copy of the root position.
+    Board(const Board &other);
+    Board &operator=(const Board &other);
+
     void pretty() const;
 
     bool is_free(const Square target) const;
@@ -78,36 +91,64 @@ class Board {
 
     MoveList get_moves() const;
     MoveList get_capture_moves() const;
+    MoveList get_quiet_moves() const;
     MoveList get_evasion_moves() const;
     MoveList get_quiessence_moves() const;
 
     void get_moves(MoveList &) const;
     void get_capture_moves(MoveList &) const;
+    void get_quiet_moves(MoveList &) const;
     void get_evasion_moves(MoveList &) const;
     void get_quiessence_moves(MoveList &) const;
 
-    bool is_attacked(const Square square) const {
-        return (aux_info->attacked & square) != 0;
-    }
+    bool is_attacked(const Square square) const { return (attacked() & square) != 0; }
 
     // Find the locations of the kings.
     void search_kings();
-    // Find the checkers and pinned pieces in a position.
+    // Find the checkers in a position.
     void update_checkers();
+    // Find the pieces pinned to our king. Only writes to the lazy fields, so it can be called from const accessors.
+    void update_pinned() const;
     // Find the check sqaures and blocker pieces (discovered checks) in a position.
-    void update_check_squares();
+    void update_check_squares() const;
     // Find the squares that are being attacked.
-    void update_attacks();
+    void update_attacks() const;
+    // Mark the lazy fields as not yet computed, after the position has changed.
+    void invalidate_lazy_info() {
+        aux_info->pinned_valid = false;
+        aux_info->check_squares_valid = false;
+        aux_info->attacked_valid = false;
+    }
     // Returns true if a given move will give check.
     bool gives_check(const Move move) const;
     // Returns the squares where p would give check.
-    Bitboard check_squares(const PieceType p) const { return aux_info->check_squares[p]; };
+    Bitboard check_squares(const PieceType p) const {
+        if (!aux_info->check_squares_valid) {
+            update_check_squares();
+        }
+        return aux_info->check_squares[p];
+    };
     // Returns the bitboard of blockers.
-    Bitboard blockers() const { return aux_info->blockers; };
+    Bitboard blockers() const {
+        if (!aux_info->check_squares_valid) {
+            update_check_squares();
+        }
+        return aux_info->blockers;
+    };
     // Returns the bitboard of pieces pinned to king.
-    Bitboard pinned() const { return aux_info->pinned; }
+    Bitboard pinned() const {
+        if (!aux_info->pinned_valid) {
+            update_pinned();
+        }
+        return aux_info->pinned;
+    }
     // Returns the bitboard of squares which are attacked by the opponent (ignoring the king).
-    Bitboard attacked() const { return aux_info->attacked; }
+    Bitboard attacked() const {
+        if (!aux_info->attacked_valid) {
+            update_attacks();
+        }
+        return aux_info->attacked;
+    }
 
     // Returns the location of the i'th checker.
     Square checkers(int i) const {
@@ -181,9 +222,15 @@ class Board {
     // Returns the move that got us to this node.
     Move last_move() const { return aux_info->last_move; }
     // One byte per square, 64 bytes total -> useful for training the nn.
-    std::array<uint8_t, N_SQUARE> byte_encoded();
+    std::array<uint8_t, N_SQUARE> byte_encoded() const;
+    // The same, written straight into `dense_board`, which must have room for N_SQUARE bytes.
+    void byte_encode(uint8_t *dense_board) const;
 
-    const Neural::accumulator_t &accumulator() const { return _accumulator; }
+    // The accumulator is only brought up to date with the moves made since it was last used when it's asked for.
+    const Neural::accumulator_t &accumulator() const {
+        update_accumulator();
+        return _accumulator;
+    }
 
   private:
     AuxilliaryInfo *aux_info;
@@ -200,7 +247,12 @@ class Board {
     ply_t root_node_ply;
     score_t _phase_material;
 
-    Neural::accumulator_t _accumulator = Neural::get_accumulator();
+    // Add the moves made since the accumulator was last brought up to date. Each ply's last_move records the pieces
+    // it changed.
+    void update_accumulator() const;
+    mutable Neural::accumulator_t _accumulator = Neural::current_accumulator();
+    // The ply the accumulator is up to date with, never ahead of ply_counter.
+    mutable ply_t accumulator_ply = 0;
 };
 
 inline Move unpack_move(const DenseMove dm, const Board &board) {
@@ -1,6 +1,8 @@
 #include "evaluate.hpp"
 #include "board.hpp"
+#include "netfile.hpp"
 #include "printing.hpp"
+#include "transposition.hpp"
 #include "zobrist.hpp"
 #include <array>
 #include <fstream>
@@ -22,8 +24,6 @@ static per_piece<score_t> phase_material = {{
 
 namespace Evaluation {
 
-static Neural::network_t network = Neural::get_network();
-
 score_t piece_phase_material(const PieceType p) {
     assert(p != NO_PIECE);
     return phase_material[p];
@@ -40,11 +40,21 @@ score_t Evaluation::count_phase_material(const Board &board) {
 }
 
 
+Neural::nn_t Evaluation::network_eval(const Board &board) {
+    const size_t bucket = Neural::network_t::output_buckets::bucket(board);
+    return Neural::current_network().forward(board.accumulator(), board.who_to_play(), bucket);
+}
+
 score_t Evaluation::eval(const Board &board) {
     // Return the eval from the point of view of the current player.
-    Neural::nn_t nn = network.forward(board.accumulator(), board.who_to_play());
+    score_t cached;
+    if (Cache::eval_cache.probe(board.hash(), cached)) {
+        return cached;
+    }
+    Neural::nn_t nn = network_eval(board);
     // TODO: Why think about centipawns at all, ideally we'd just map the output to the score_t range.
     auto mapped = std::clamp(static_cast<score_t>(nn * Neural::LOGISTIC_SCALING), static_cast<score_t>(1-MIN_MATE_SCORE), static_cast<score_t>(MIN_MATE_SCORE-1)); 
+    Cache::eval_cache.store(board.hash(), mapped);
     return mapped;
 }
 
@@ -66,7 +76,8 @@ score_t Evaluation::terminal(const Board &board) {
 
 // Get the true static evaluation for any node, does the check if the node is a terminal node.
 score_t Evaluation::evaluate_safe(const Board &board) {
-    std::vector<Move> legal_moves = board.get_moves();
+    MoveList legal_moves;
+    board.get_moves(legal_moves);
     if (legal_moves.empty()) {
         return terminal(board);
     } else {
@@ -6,6 +6,9 @@ namespace Evaluation {
 // Calculate the evaluation heuristic from the player's POV
 score_t eval(const Board &board);
 
+// The raw network output from the player's POV, without the eval cache.
+Neural::nn_t network_eval(const Board &board);
+
 // Calculate the evaluation heuristic from white's POV.
 score_t evaluate_white(const Board &board);
 
@@ -609,7 +609,6 @@ void Board::get_moves(MoveList &moves) const {
 
 MoveList Board::get_moves() const {
     MoveList moves;
-    moves.reserve(MAX_MOVES);
     get_moves(moves);
     return moves;
 }
@@ -626,7 +625,6 @@ void Board::get_quiessence_moves(MoveList &moves) const {
 
 MoveList Board::get_quiessence_moves() const {
     MoveList moves;
-    moves.reserve(MAX_MOVES);
     get_quiessence_moves(moves);
     return moves;
 }
@@ -634,15 +632,20 @@ MoveList Board::get_quiessence_moves() const {
 void Board::get_capture_moves(MoveList &moves) const { generate_moves<CAPTURES>(*this, moves); }
 MoveList Board::get_capture_moves() const {
     MoveList moves;
-    moves.reserve(MAX_MOVES);
     get_capture_moves(moves);
     return moves;
 }
 
+void Board::get_quiet_moves(MoveList &moves) const { generate_moves<QUIET>(*this, moves); }
+MoveList Board::get_quiet_moves() const {
+    MoveList moves;
+    get_quiet_moves(moves);
+    return moves;
+}
+
 void Board::get_evasion_moves(MoveList &moves) const { generate_moves<EVASIONS>(*this, moves); }
 MoveList Board::get_evasion_moves() const {
     MoveList moves;
-    moves.reserve(MAX_MOVES);
     get_evasion_moves(moves);
     return moves;
 }
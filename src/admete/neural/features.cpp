@@ -48,6 +48,28 @@ per_colour<Feature2Vector> encode2(const Board &board) {
     return features;
 }
 
+per_colour<Square> king_squares(const Board &board) {
+    per_colour<Square> kings;
+    for (Colour c : {WHITE, BLACK}) {
+        kings[c] = board.find_king(c);
+    }
+    return kings;
+}
+
+per_colour<per_piece<Bitboard>> piece_bitboards(const Board &board) {
+    per_colour<per_piece<Bitboard>> bitboards;
+    for (Colour c : {WHITE, BLACK}) {
+        for (PieceType p = PAWN; p < N_PIECE; p++) {
+            bitboards[c][p] = board.pieces(c, p);
+        }
+    }
+    return bitboards;
+}
+
+size_t piece_count(const Board &board) { return count_bits(board.pieces()); }
+
+score_t phase_material(const Board &board) { return board.phase_material(); }
+
 per_colour<FeatureDiff> increment(const Move &move, const Colour us, const bool forward) {
     assert(move != NULL_MOVE);
     const PieceType p = move.moving_piece;
@@ -3,6 +3,7 @@
 #include <types.hpp>
 #include <bitboard.hpp>
 #include <linalg.hpp>
+#include <algorithm>
 #include <tuple>
 
 class Board;  // Forward declare
@@ -12,16 +13,73 @@ namespace Neural {
   inline constexpr size_t N_FEATURES = 64 * 6; // a bitboard for each piece type (for each color)
   inline constexpr size_t N_FEATURES2 = 64 * 5; // a bitboard for each piece type except the king (for each color)
   using feature_t = int8_t;
+  // A move changes at most four features for one side: the moving piece (or rook, when castling) leaves one square
+  // and arrives on another.
+  inline constexpr size_t MAX_FEATURE_CHANGES = 4;
   
   typedef Vector<feature_t, N_FEATURES> FeatureVector;
-  typedef SparseVector<feature_t, N_FEATURES> FeatureDiff;
+  typedef SparseVector<feature_t, N_FEATURES, MAX_FEATURE_CHANGES> FeatureDiff;
   typedef std::tuple<Vector<feature_t, N_FEATURES2>, Square> Feature2Vector;
   typedef std::tuple<SparseVector<feature_t, N_FEATURES2>, Square, Square> Feature2Diff;
+
+  // King buckets. With bucketed features, each side's features are repeated once per bucket, and only the copy for the
+  // bucket its king is in (from its own point of view) is set. Back rank or not, queen or king side.
+  inline constexpr size_t N_KING_BUCKETS = 4;
+  inline size_t king_bucket(const Square relative_king) {
+    return (relative_king.rank() == RANK1 ? 0 : 2) + (relative_king.file() >= FILEE ? 1 : 0);
+  }
+  // The bucket for a network with KingBuckets buckets, where a single bucket is the plain feature set.
+  template <size_t KingBuckets>
+  size_t king_bucket(const Square king, const Colour c) {
+    static_assert(KingBuckets == 1 || KingBuckets == N_KING_BUCKETS, "Unknown king bucket layout");
+    if constexpr (KingBuckets == 1) {
+      return 0;
+    } else {
+      return king_bucket(king.relative(c));
+    }
+  }
+
+  // Output buckets. The last Depth layers of the network can have a copy for each bucket, with the one used picked from
+  // the material left on the board, so the endgame gets weights of its own. A single bucket is the plain network.
+  size_t piece_count(const Board &board);
+  score_t phase_material(const Board &board);
+
+  template <size_t Buckets = 1, size_t Depth = 1>
+  struct PieceCountBuckets {
+    static constexpr size_t N = Buckets;
+    static constexpr size_t depth = Depth;
+    static size_t bucket(const Board &board) {
+      if constexpr (Buckets == 1) {
+        return 0;
+      } else {
+        // Up to 32 pieces, kings included, split evenly.
+        return std::min((piece_count(board) - 1) * Buckets / 32, Buckets - 1);
+      }
+    }
+  };
+
+  template <size_t Buckets = 1, size_t Depth = 1>
+  struct PhaseMaterialBuckets {
+    static constexpr size_t N = Buckets;
+    static constexpr size_t depth = Depth;
+    static size_t bucket(const Board &board) {
+      if constexpr (Buckets == 1) {
+        return 0;
+      } else {
+        // Anything above the opening material counts as the opening.
+        const size_t material = std::clamp<score_t>(phase_material(board), 0, OPENING_MATERIAL);
+        return std::min(material * Buckets / static_cast<size_t>(OPENING_MATERIAL), Buckets - 1);
+      }
+    }
+  };
+
   // We can keep these functions pure for now. So let's do that.
 
   per_colour<FeatureVector> encode(const Board &board);
   per_colour<Feature2Vector> encode2(const Board &board);
   per_colour<FeatureDiff> increment(const Move &move, const Colour us, const bool forward);
+  per_colour<Square> king_squares(const Board &board);
+  per_colour<per_piece<Bitboard>> piece_bitboards(const Board &board);
 
   
 } // namespace Neural
\ No newline at end of file
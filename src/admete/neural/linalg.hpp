@@ -1,5 +1,7 @@
 #pragma once
 #include <types.hpp>
+#include <cstdint>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 
@@ -116,29 +118,43 @@ namespace Neural {
         }
     };
 
-    // sparse vector
-    template <typename T, size_t N>
+    // sparse vector, with room for up to Capacity non-zero entries. They're kept inline, so that building one (i.e. a
+    // feature diff for every move) never touches the heap.
+    template <typename T, size_t N, size_t Capacity = 8>
     struct SparseVector {
-        alignas(cache_line_size) std::vector<std::pair<size_t, T>> data;
+        using index_t = uint16_t;
+        static_assert(N <= std::numeric_limits<index_t>::max(), "SparseVector indices are 16 bit");
+        static_assert(Capacity <= std::numeric_limits<uint8_t>::max(), "SparseVector capacity is too large");
+        struct Entry {
+            index_t index;
+            T value;
+        };
+
         constexpr size_t size() const { return N; }
+        size_t count() const { return _count; }
+        bool empty() const { return _count == 0; }
+
+        const Entry *begin() const { return data; }
+        const Entry *end() const { return data + _count; }
 
         // indexing
         void set(size_t i, T value) {
             // assume that it has not been set before (performance > safety here sorry future me)
             assert(i < N);
+            assert(_count < Capacity);
             #ifndef NDEBUG
-            for (auto& [index, _] : data) {
+            for (auto& [index, _] : *this) {
                 assert(index != i);
             }
             #endif
-            data.push_back({i, value});
+            data[_count++] = {static_cast<index_t>(i), value};
         }
 
         // dot product
         T dot(const Vector<T, N>& other) const {
             T result = 0;
 
-            for (const auto& [index, value] : data) {
+            for (const auto& [index, value] : *this) {
                 result += value * other[index];
             }
             return result;
@@ -149,7 +165,7 @@ namespace Neural {
             for (size_t i = 0; i < N; i++) {
                 result[i] = other[i];
             }
-            for (const auto& [index, value] : data) {
+            for (const auto& [index, value] : *this) {
                 result[index] += value;
             }
             return result;
@@ -160,20 +176,24 @@ namespace Neural {
             for (size_t i = 0; i < N; i++) {
                 result[i] = 0;
             }
-            for (const auto& [index, value] : data) {
+            for (const auto& [index, value] : *this) {
                 result[index] = value;
             }
             return result;
         }
 
         template <typename U>
-        SparseVector<U, N> cast_as() const {
-            SparseVector<U, N> result;
-            for (const auto& [index, value] : data) {
+        SparseVector<U, N, Capacity> cast_as() const {
+            SparseVector<U, N, Capacity> result;
+            for (const auto& [index, value] : *this) {
                 result.set(index, static_cast<U>(value));
             }
             return result;
         }
+
+      private:
+        Entry data[Capacity];
+        uint8_t _count = 0;
     };
 
     // Matrix
@@ -0,0 +1,187 @@
+#include "netfile.hpp"
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Neural {
+
+namespace {
+using quantized_t = network_t::quantized_t;
+constexpr size_t n_layers = network_t::n_layers;
+constexpr size_t n_buckets = network_t::output_buckets::N;
+constexpr size_t max_layers = 8;
+static_assert(n_layers <= max_layers);
+
+struct NetFileHeader {
+    uint64_t magic;
+    uint32_t version;
+    // Accumulator inputs for one side, i.e. with any king buckets.
+    uint32_t n_inputs;
+    uint32_t n_accumulated;
+    uint32_t n_layers;
+    uint32_t layer_sizes[max_layers];
+    uint32_t n_output_buckets;
+};
+static_assert(sizeof(NetFileHeader) <= net_file_header_size);
+
+struct Net {
+    accumulator_t accumulator;
+    quantized_t network;
+};
+
+Net &compiled_in() {
+    static Net net = {get_accumulator(), quantized_t(get_network())};
+    return net;
+}
+
+std::unique_ptr<Net> loaded;
+
+Net &current() { return loaded ? *loaded : compiled_in(); }
+
+template <size_t I = 0>
+void expected_sizes(uint32_t *sizes) {
+    if constexpr (I < n_layers) {
+        sizes[I] = network_t::layer_t<I>::Out;
+        expected_sizes<I + 1>(sizes);
+    }
+}
+
+constexpr size_t layer_floats(const size_t in, const size_t out) { return in * out + out; }
+
+// Bucketed layers are stored one bucket after another.
+constexpr size_t layer_copies(const size_t I) { return network_t::bucketed(I) ? n_buckets : 1; }
+
+template <size_t I = 0>
+constexpr size_t network_floats() {
+    if constexpr (I == n_layers) {
+        return 0;
+    } else {
+        using layer_t = network_t::layer_t<I>;
+        return layer_copies(I) * layer_floats(layer_t::In, layer_t::Out) + network_floats<I + 1>();
+    }
+}
+
+// Build the layers from the weights, which run on from `data`.
+template <size_t I = 0>
+void read_layers(network_t &network, const float *data) {
+    if constexpr (I < n_layers) {
+        using layer_t = network_t::layer_t<I>;
+        for (size_t bucket = 0; bucket < layer_copies(I); bucket++) {
+            network.set_layer<I>(bucket, std::make_unique<layer_t>(data, data + layer_t::In * layer_t::Out));
+            data += layer_floats(layer_t::In, layer_t::Out);
+        }
+        read_layers<I + 1>(network, data);
+    }
+}
+
+template <size_t I = 0>
+void write_layers(std::ofstream &file, const network_t &network) {
+    if constexpr (I < n_layers) {
+        using layer_t = network_t::layer_t<I>;
+        std::vector<float> data;
+        data.reserve(layer_copies(I) * layer_floats(layer_t::In, layer_t::Out));
+        for (size_t bucket = 0; bucket < layer_copies(I); bucket++) {
+            const auto &layer = network.layer<I>(bucket);
+            for (size_t j = 0; j < layer_t::In; j++) {
+                for (size_t i = 0; i < layer_t::Out; i++) {
+                    data.push_back(layer.weight_at(i, j));
+                }
+            }
+            for (size_t i = 0; i < layer_t::Out; i++) {
+                data.push_back(layer.bias_at(i));
+            }
+        }
+        file.write(reinterpret_cast<const char *>(data.data()), data.size() * sizeof(float));
+        write_layers<I + 1>(file, network);
+    }
+}
+
+// The accumulator layer may have weights for each king bucket, or just the one set that all the buckets share.
+template <size_t Inputs>
+std::unique_ptr<Net> read_net(const float *data) {
+    constexpr size_t weights = 2 * Inputs * N_ACCUMULATED;
+    auto layer = std::make_unique<FloatingAccumulatorLayer<nn_t, Inputs, N_ACCUMULATED>>(data, data + weights);
+    network_t network;
+    read_layers(network, data + weights + N_ACCUMULATED);
+    return std::make_unique<Net>(accumulator_t(std::move(layer)), quantized_t(network));
+}
+
+} // namespace
+
+const accumulator_t &current_accumulator() { return current().accumulator; }
+
+const network_t::quantized_t &current_network() { return current().network; }
+
+bool load_network(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    NetFileHeader info;
+    file.read(reinterpret_cast<char *>(&info), sizeof(info));
+    uint32_t sizes[max_layers] = {};
+    expected_sizes(sizes);
+    if (!file || info.magic != net_file_magic || info.version != net_file_version ||
+        info.n_accumulated != N_ACCUMULATED || info.n_layers != n_layers ||
+        std::memcmp(info.layer_sizes, sizes, sizeof(sizes)) != 0 || info.n_output_buckets != n_buckets ||
+        (info.n_inputs != accumulator_t::InputSize && info.n_inputs != N_FEATURES)) {
+        return false;
+    }
+    const size_t n_floats = layer_floats(2 * info.n_inputs, N_ACCUMULATED) + network_floats();
+    file.seekg(0, std::ios::end);
+    if (size_t(file.tellg()) != net_file_header_size + n_floats * sizeof(float)) {
+        return false;
+    }
+
+    // The weights are quantized as the layers are built, so the floats are only needed until then.
+    std::vector<float> weights(n_floats);
+    file.seekg(net_file_header_size);
+    file.read(reinterpret_cast<char *>(weights.data()), n_floats * sizeof(float));
+    if (!file) {
+        return false;
+    }
+
+    if constexpr (accumulator_t::InputSize != N_FEATURES) {
+        if (info.n_inputs == N_FEATURES) {
+            loaded = read_net<N_FEATURES>(weights.data());
+            return true;
+        }
+    }
+    loaded = read_net<accumulator_t::InputSize>(weights.data());
+    return true;
+}
+
+void reset_network() { loaded.reset(); }
+
+bool save_network(const std::string &path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    const auto layer = generated::gen_accumulator();
+    constexpr size_t inputs = N_FEATURES;
+
+    char header[net_file_header_size] = {};
+    NetFileHeader info = {net_file_magic, net_file_version, inputs, N_ACCUMULATED, n_layers, {}, n_buckets};
+    expected_sizes(info.layer_sizes);
+    std::memcpy(header, &info, sizeof(info));
+    file.write(header, net_file_header_size);
+
+    std::vector<float> data;
+    data.reserve(layer_floats(2 * inputs, N_ACCUMULATED));
+    for (size_t j = 0; j < 2 * inputs; j++) {
+        for (size_t i = 0; i < N_ACCUMULATED; i++) {
+            data.push_back(layer->weight_at(i, j));
+        }
+    }
+    for (size_t i = 0; i < N_ACCUMULATED; i++) {
+        data.push_back(layer->bias_at(i));
+    }
+    file.write(reinterpret_cast<const char *>(data.data()), data.size() * sizeof(float));
+    write_layers(file, get_network());
+    return file.good();
+}
+
+} // namespace Neural
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include <weights.hpp>
+
+namespace Neural {
+
+// Networks can be loaded from binary files at runtime, rather than compiled in. A file is a header padded to
+// net_file_header_size, followed by the float weights and biases of each layer (the accumulator layer first) in the
+// order the layers' pointer constructors read them, with each output bucket's copy of a bucketed layer in turn. The
+// floats are read in and quantized into new layers, as the compiled in weights are, so the file is not mapped or used
+// in place. The compiled in network is still built from the generated weights, not stored in this format. The version
+// is bumped whenever the layout changes.
+constexpr uint64_t net_file_magic = 0x54454e54454d4441; // "ADMETNET"
+constexpr uint32_t net_file_version = 2;
+constexpr size_t net_file_header_size = 64;
+
+// The network that new boards and the evaluation use: the compiled in one, unless a file has been loaded.
+const accumulator_t &current_accumulator();
+const network_t::quantized_t &current_network();
+
+// Replace the current network with one from a file, or go back to the compiled in one. A failed load returns false and
+// leaves the current network as it was. Boards pick the new network up the next time they are set up with a position,
+// or when Board::reload_network is called.
+bool load_network(const std::string &path);
+void reset_network();
+// Write the compiled in network to a file.
+bool save_network(const std::string &path);
+
+} // namespace Neural
@@ -3,9 +3,16 @@
 #include <linalg.hpp>
 #include <features.hpp>
 #include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
 #include <limits>
 #include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include <fixed.hpp>
+#include <simd.hpp>
 
 namespace Neural {
   typedef float nn_t;
@@ -104,14 +111,15 @@ namespace Neural {
         return result;
       }
 
-      void increment(Vector<T, Out>& reference, const SparseVector<T, HalfIn>& input_left, const SparseVector<T, HalfIn>& input_right) const {
+      template <size_t Capacity>
+      void increment(Vector<T, Out>& reference, const SparseVector<T, HalfIn, Capacity>& input_left, const SparseVector<T, HalfIn, Capacity>& input_right) const {
         // We want to concatenate the two inputs, and then propogate. This allows us to do them without copying.
-        for (const auto& [index, value] : input_left.data) {
+        for (const auto& [index, value] : input_left) {
           for (size_t i = 0; i < Out; i++) {
             reference[i] += weights.at(index, i) * value;
           }
         }
-        for (const auto& [index, value] : input_right.data) {
+        for (const auto& [index, value] : input_right) {
           for (size_t i = 0; i < Out; i++) {
             reference[i] += weights.at(index + HalfIn, i) * value;
           }
@@ -139,11 +147,14 @@ namespace Neural {
 
     FixedAccumulatorLayer() = default; 
 
-    template<typename floatT>
-    FixedAccumulatorLayer(const FloatingAccumulatorLayer<floatT, HalfIn, Out>& layer) {
+    // A layer with fewer inputs per side (i.e. without king buckets) has its weights repeated to fill each half.
+    template<typename floatT, size_t LayerHalfIn>
+    FixedAccumulatorLayer(const FloatingAccumulatorLayer<floatT, LayerHalfIn, Out>& layer) {
+        static_assert(HalfIn % LayerHalfIn == 0, "Can't fill the inputs with the layer's weights");
         for (size_t j = 0; j < In; j++) {
+            const size_t layer_j = (j < HalfIn) ? j % LayerHalfIn : LayerHalfIn + (j - HalfIn) % LayerHalfIn;
             for (size_t i = 0; i < Out; i++) {
-                floatT float_weight = layer.weight_at(i, j);
+                floatT float_weight = layer.weight_at(i, layer_j);
                 weights.at(j, i) = accT::from_float(float_weight);
             }
         }
@@ -157,27 +168,48 @@ namespace Neural {
     Vector<accT, Out> forward(const Vector<inT, HalfIn>& input_left, const Vector<inT, HalfIn>& input_right) const {
       Vector<accT, Out> result = bias;
 
+      // The features are mostly zero, those rows can be skipped.
       for (size_t j = 0; j < HalfIn; j++) {
-        for (size_t i = 0; i < Out; i++) {
-          result[i] += weights.at(j, i).small_multiply(input_left[j]);
-          result[i] += weights.at(j + HalfIn, i).small_multiply(input_right[j]);
+        if (input_left[j] != 0) {
+          add_row(result, j, input_left[j]);
+        }
+        if (input_right[j] != 0) {
+          add_row(result, j + HalfIn, input_right[j]);
         }
       }
       return result;
     }
 
-    void increment(Vector<accT, Out>& reference, const SparseVector<inT, HalfIn>& input_left, const SparseVector<inT, HalfIn>& input_right) const {
+    template <size_t Capacity>
+    void increment(Vector<accT, Out>& reference, const SparseVector<inT, HalfIn, Capacity>& input_left, const SparseVector<inT, HalfIn, Capacity>& input_right) const {
       // We want to concatenate the two inputs, and then propogate. This allows us to do them without copying.
-      for (const auto& [index, value] : input_left.data) {
-        for (size_t i = 0; i < Out; i++) {
-          reference[i] += weights.at(index, i).small_multiply(value);
-        }
+      for (const auto& [index, value] : input_left) {
+        add_row(reference, index, value);
       }
-      for (const auto& [index, value] : input_right.data) {
-        for (size_t i = 0; i < Out; i++) {
-          reference[i] += weights.at(index + HalfIn, i).small_multiply(value);
+      for (const auto& [index, value] : input_right) {
+        add_row(reference, index + HalfIn, value);
+      }
+    }
+
+    const Vector<accT, Out>& get_bias() const { return bias; }
+
+    // output += value * row j of the weights. The features are +-1, so with 16 bit weights this is a plain SIMD add
+    // or subtract of the row.
+    void add_row(Vector<accT, Out>& output, const size_t j, const inT value) const {
+      if constexpr (std::is_same_v<typename accT::int_type, int16_t> && sizeof(accT) == sizeof(int16_t)) {
+        int16_t* out = reinterpret_cast<int16_t*>(output.data);
+        const int16_t* row = reinterpret_cast<const int16_t*>(&weights.at(j, 0));
+        if (value == 1) {
+          simd::add(out, row, Out);
+          return;
+        } else if (value == -1) {
+          simd::sub(out, row, Out);
+          return;
         }
       }
+      for (size_t i = 0; i < Out; i++) {
+        output[i] += weights.at(j, i).small_multiply(value);
+      }
     }
 
     private:
@@ -198,12 +230,101 @@ namespace Neural {
     return result;
   }
 
-  template <size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift>
+  // The quantized hidden layers work on activations clipped to [0, 2) with this many fractional bits, so that they fit
+  // in an int8. The float network is trained with a plain ReLU, clipping at 1 loses too much.
+  constexpr uint8_t QUANT_ACT_SHIFT = 6;
+  constexpr int32_t QUANT_ACT_MAX = std::numeric_limits<int8_t>::max();
+
+  // Round to an integer with `shift` fractional bits, saturating at the limits of intT.
+  template <typename intT, typename floatT>
+  intT quantize(const floatT value, const uint8_t shift) {
+    const floatT scaled = std::round(std::ldexp(value, shift));
+    return static_cast<intT>(std::clamp(scaled, static_cast<floatT>(std::numeric_limits<intT>::min()),
+                                        static_cast<floatT>(std::numeric_limits<intT>::max())));
+  }
+
+  // Clipped ReLU from an integer with `shift` fractional bits to an activation.
+  template <typename T, size_t N>
+  Vector<uint8_t, N> clipped_relu(const Vector<T, N>& x, const uint8_t shift) {
+    assert(shift > QUANT_ACT_SHIFT);
+    const uint8_t drop = shift - QUANT_ACT_SHIFT;
+    // Round to nearest rather than down, truncating would bias every activation.
+    const int32_t half = 1 << (drop - 1);
+    Vector<uint8_t, N> result;
+    for (size_t i = 0; i < N; i++) {
+      result[i] = static_cast<uint8_t>(std::clamp<int32_t>((x[i] + half) >> drop, 0, QUANT_ACT_MAX));
+    }
+    return result;
+  }
+
+  // Integer version of a LinearLayer. The weights are scaled by the largest power of two that keeps them all within wT,
+  // the inputs are activations and the outputs are the exact int32 sums, with out_shift() fractional bits.
+  template <typename wT, size_t Input, size_t Output>
+  class QuantizedLinearLayer {
+  static_assert(std::is_integral_v<wT> && std::is_signed_v<wT>, "QuantizedLinearLayer only supports signed integer weights");
+
+  public:
+    static constexpr size_t In = Input;
+    static constexpr size_t Out = Output;
+
+    QuantizedLinearLayer() = default;
+
+    template <typename floatT>
+    QuantizedLinearLayer(const LinearLayer<floatT, Input, Output>& layer) {
+      floatT max_weight = 0;
+      for (size_t i = 0; i < Output; i++) {
+        for (size_t j = 0; j < Input; j++) {
+          max_weight = std::max(max_weight, std::abs(layer.weight_at(i, j)));
+        }
+      }
+      // Leave room in the int32 sums for the activations and a sum over the inputs.
+      while (weight_shift < 16 &&
+             std::round(std::ldexp(max_weight, weight_shift + 1)) <= std::numeric_limits<wT>::max()) {
+        weight_shift++;
+      }
+      for (size_t i = 0; i < Output; i++) {
+        for (size_t j = 0; j < Input; j++) {
+          weights.at(i, j) = quantize<wT>(layer.weight_at(i, j), weight_shift);
+        }
+        bias[i] = quantize<int32_t>(layer.bias_at(i), out_shift());
+      }
+    }
+
+    Vector<int32_t, Output> forward(const Vector<uint8_t, Input>& input) const {
+      Vector<int32_t, Output> result = bias;
+      for (size_t i = 0; i < Output; i++) {
+        if constexpr (std::is_same_v<wT, int8_t>) {
+          result[i] += simd::dot(input.data, &weights.at(i, 0), Input);
+        } else {
+          for (size_t j = 0; j < Input; j++) {
+            result[i] += static_cast<int32_t>(weights.at(i, j)) * input[j];
+          }
+        }
+      }
+      return result;
+    }
+
+    uint8_t out_shift() const { return QUANT_ACT_SHIFT + weight_shift; }
+
+  private:
+    // Stored by output (unlike LinearLayer), so that each output is one contiguous dot product.
+    Matrix<wT, Output, Input> weights;
+    Vector<int32_t, Output> bias;
+    uint8_t weight_shift = 0;
+  };
+
+  // With KingBuckets > 1 the inputs are the features repeated for each king bucket (see features.hpp). Each
+  // perspective's half, both its own pieces and the other side's, is bucketed by that perspective's king. Moves update
+  // the accumulator incrementally, except a king move into a new bucket, after which refresh() rebuilds the mover's
+  // half. Rebuilds (and initialise()) start from the last state built for the same side and bucket, and only add and
+  // remove the pieces that differ from it.
+  template <size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, size_t KingBuckets = 1>
   class Accumulator {
   public:
       // using layer_t = FloatingAccumulatorLayer<nn_t, FeaturesSize, AccumulatorSize>;
       static constexpr uint8_t acc_bits = 16u;
-      using layer_t = FixedAccumulatorLayer<FeaturesSize, AccumulatorSize, acc_bits, AccumulatorShift>;
+      static constexpr size_t InputSize = FeaturesSize * KingBuckets;
+      using layer_t = FixedAccumulatorLayer<InputSize, AccumulatorSize, acc_bits, AccumulatorShift>;
       using accT = layer_t::accT;
       using floating_t = FloatingAccumulatorLayer<nn_t, FeaturesSize, AccumulatorSize>;
 
@@ -215,109 +336,337 @@ namespace Neural {
       explicit Accumulator(const layer_t& layer)
           : acc_layer(std::make_unique<layer_t>(layer)) {}
 
-      explicit Accumulator(std::unique_ptr<floating_t> layer)
+      // Floating point weights, either for all the buckets or shared by them.
+      template <size_t LayerHalfIn>
+      explicit Accumulator(std::unique_ptr<FloatingAccumulatorLayer<nn_t, LayerHalfIn, AccumulatorSize>> layer)
           : acc_layer(std::make_unique<layer_t>(*layer)) {}
         
-      explicit Accumulator(const floating_t& layer)
+      template <size_t LayerHalfIn>
+      explicit Accumulator(const FloatingAccumulatorLayer<nn_t, LayerHalfIn, AccumulatorSize>& layer)
           : acc_layer(std::make_unique<layer_t>(layer)) {}
       
-      Accumulator(Accumulator&& other) noexcept 
-          : acc_layer(std::move(other.acc_layer))
-          , accumulated(std::move(other.accumulated)) {}
-      
-      Accumulator& operator=(Accumulator&& other) noexcept {
-          acc_layer = std::move(other.acc_layer);
-          accumulated = std::move(other.accumulated);
-          return *this;
-      }
-
       void initialise(const Board& board);
+      // Push the state after the move, computed from the current state plus the move's feature changes.
       void make_move(const Move& move, const Colour side);
-      void unmake_move(const Move& move, const Colour side);
-      const Vector<accT, AccumulatorSize>& get(Colour c) const { return accumulated[c]; }
+      // Push the state for the board, after a move that needs_refresh(). The mover's half is rebuilt, the other
+      // side's still follows the move incrementally.
+      void refresh(const Board& board, const Move& move, const Colour side);
+      // Pop back to the state before the last move, which is still on the stack.
+      void unmake_move() {
+          assert(height > 0);
+          height--;
+      }
+      const Vector<accT, AccumulatorSize>& get(Colour c) const { return accumulated[height][c]; }
+
+      // Switch to the weights another accumulator uses (i.e. the current network's), if they are different.
+      void use_weights_of(const Accumulator& other) {
+          if (acc_layer != other.acc_layer) {
+              acc_layer = other.acc_layer;
+              refresh_table.assign(refresh_table.size(), RefreshEntry());
+          }
+      }
+
+      // Whether the move takes a king into another bucket, so the mover's half can't be updated incrementally.
+      static bool needs_refresh(const Move& move, const Colour side) {
+          if constexpr (KingBuckets == 1) {
+              return false;
+          } else {
+              return move.moving_piece == KING &&
+                     king_bucket<KingBuckets>(move.origin, side) != king_bucket<KingBuckets>(move.target, side);
+          }
+      }
 
       template<typename T>
       const Vector<T, AccumulatorSize> get_as(Colour c) const {
           auto values = Vector<T, AccumulatorSize>::zeros();
           for (size_t i = 0; i < AccumulatorSize; i++) {
-              values[i] = accumulated[c][i].template as<T>();
+              values[i] = get(c)[i].template as<T>();
           }
           return values;
       }
 
     private:
-      per_colour<Vector<accT, AccumulatorSize>> accumulated;
-      std::unique_ptr<layer_t> acc_layer;
+      // Recompute one perspective's half of the state at the current height from the board.
+      void compute(const Board& board, const Colour perspective);
+      // Build one perspective's half of the state at the current height from the one below, with a move's feature
+      // changes.
+      void update(const per_colour<FeatureDiff>& diff, const Colour perspective);
+
+      // A state built from scratch, for one side and its bucket, with the pieces it was built for.
+      struct RefreshEntry {
+          Vector<accT, AccumulatorSize> accumulated;
+          per_colour<per_piece<Bitboard>> pieces = {};
+          bool filled = false;
+      };
+      // Indexed by the side and the bucket of its king.
+      std::vector<RefreshEntry> refresh_table = std::vector<RefreshEntry>(N_COLOUR * KingBuckets);
+
+      // One state per move made since initialise(), the top is the current position. The stack only grows, so the
+      // same entries are reused as the search goes up and down the tree.
+      std::vector<per_colour<Vector<accT, AccumulatorSize>>> accumulated =
+          std::vector<per_colour<Vector<accT, AccumulatorSize>>>(1);
+      // The offset of each perspective's bucket in the inputs, for each state on the stack.
+      std::vector<per_colour<size_t>> offsets = std::vector<per_colour<size_t>>(1);
+      size_t height = 0;
+      // The layer weights are read-only once built, so copies of an accumulator (i.e. of a board, for a search
+      // thread) share them.
+      std::shared_ptr<const layer_t> acc_layer;
   };
 
-  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift>
-  void Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift>::initialise(const Board &board) {
-      auto encoded = encode(board);
-      for (Colour c : {WHITE, BLACK}) {
-          accumulated[c] = acc_layer->forward(encoded[c], encoded[~c]);
+  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, size_t KingBuckets>
+  void Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift, KingBuckets>::initialise(const Board &board) {
+      height = 0;
+      compute(board, WHITE);
+      compute(board, BLACK);
+  }
+
+  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, size_t KingBuckets>
+  void Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift, KingBuckets>::compute(const Board &board,
+                                                                                         const Colour perspective) {
+      const auto pieces = piece_bitboards(board);
+      // The perspective's king, on its own side's oriented board, picks the bucket for both halves.
+      const size_t bucket = king_bucket<KingBuckets>(king_squares(board)[perspective], perspective);
+      offsets[height][perspective] = bucket * FeaturesSize;
+      RefreshEntry &entry = refresh_table[perspective * KingBuckets + bucket];
+      if (!entry.filled) {
+          entry.accumulated = acc_layer->get_bias();
+          entry.filled = true;
+      }
+      // Our pieces are in the first half of the inputs, theirs in the second.
+      for (Colour c : {perspective, ~perspective}) {
+          const size_t offset = offsets[height][perspective] + (c == perspective ? 0 : InputSize);
+          for (PieceType p = PAWN; p < N_PIECE; p++) {
+              Bitboard added = pieces[c][p] & ~entry.pieces[c][p];
+              Bitboard removed = entry.pieces[c][p] & ~pieces[c][p];
+              while (added) {
+                  acc_layer->add_row(entry.accumulated, offset + p * 64 + pop_lsb(&added).relative(c), 1);
+              }
+              while (removed) {
+                  acc_layer->add_row(entry.accumulated, offset + p * 64 + pop_lsb(&removed).relative(c), -1);
+              }
+          }
       }
+      entry.pieces = pieces;
+      accumulated[height][perspective] = entry.accumulated;
   }
 
-  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift>
-  void Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift>::make_move(const Move &move, const Colour side) {
-      auto diff = increment(move, side, true);
-      acc_layer->increment(accumulated[side], diff[side], diff[~side]);
-      acc_layer->increment(accumulated[~side], diff[~side], diff[side]);
+  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, size_t KingBuckets>
+  void Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift, KingBuckets>::update(
+      const per_colour<FeatureDiff> &diff, const Colour perspective) {
+      accumulated[height][perspective] = accumulated[height - 1][perspective];
+      offsets[height][perspective] = offsets[height - 1][perspective];
+      if constexpr (KingBuckets == 1) {
+          acc_layer->increment(accumulated[height][perspective], diff[perspective], diff[~perspective]);
+      } else {
+          // Both halves are in the perspective's bucket.
+          per_colour<SparseVector<feature_t, InputSize, MAX_FEATURE_CHANGES>> bucketed;
+          for (Colour c : {WHITE, BLACK}) {
+              for (const auto& [index, value] : diff[c]) {
+                  bucketed[c].set(offsets[height][perspective] + index, value);
+              }
+          }
+          acc_layer->increment(accumulated[height][perspective], bucketed[perspective], bucketed[~perspective]);
+      }
   }
 
-  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift>
-  void Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift>::unmake_move(const Move &move, const Colour side) {
-      auto diff = increment(move, side, false);
+  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, size_t KingBuckets>
+  void Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift, KingBuckets>::make_move(const Move &move, const Colour side) {
+      assert(!needs_refresh(move, side));
+      if (height + 1 == accumulated.size()) {
+          accumulated.emplace_back();
+          offsets.emplace_back();
+      }
+      const auto diff = increment(move, side, true);
+      height++;
+      update(diff, side);
+      update(diff, ~side);
+  }
 
-      acc_layer->increment(accumulated[side], diff[side], diff[~side]);
-      acc_layer->increment(accumulated[~side], diff[~side], diff[side]);
+  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, size_t KingBuckets>
+  void Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift, KingBuckets>::refresh(const Board &board,
+                                                                                         const Move &move,
+                                                                                         const Colour side) {
+      if (height + 1 == accumulated.size()) {
+          accumulated.emplace_back();
+          offsets.emplace_back();
+      }
+      height++;
+      // The other side's king hasn't moved, so its half stays in the same bucket.
+      update(increment(move, side, true), ~side);
+      compute(board, side);
   }
 
-  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, size_t... LayerSizes>
-  class Network {
-  private:    
-    // Recursive template to build a tuple of layers
-    // Base case - just one layer left
-    template<size_t In, size_t Out, size_t... Rest>
-    struct LayerTypes {
-        using type = std::tuple<std::unique_ptr<LinearLayer<nn_t, In, Out>>>;
-    };
-    // Recursive case - concatenate current layer with rest of layers
-    template<size_t In, size_t Mid, size_t Out, size_t... Rest>
-    struct LayerTypes<In, Mid, Out, Rest...> {
-        using type = decltype(std::tuple_cat(
-            std::declval<std::tuple<std::unique_ptr<LinearLayer<nn_t, In, Mid>>>>(),
-            std::declval<typename LayerTypes<Mid, Out, Rest...>::type>()
-        ));
-    };
+  // The sizes of a network's layers, starting from the accumulator, and which of them have a copy for each output
+  // bucket (see features.hpp). With a single bucket every layer is a plain layer.
+  template<typename OutputBuckets, size_t... Sizes>
+  struct LayerShape {
+    static constexpr size_t n_layers = sizeof...(Sizes) - 1;
+    static constexpr std::array<size_t, sizeof...(Sizes)> sizes = {Sizes...};
+    static_assert(OutputBuckets::N >= 1 && OutputBuckets::depth >= 1 && OutputBuckets::depth <= n_layers,
+                  "Output buckets must cover between one and all of the layers");
+
+    static constexpr bool bucketed(const size_t I) { return OutputBuckets::N > 1 && I + OutputBuckets::depth >= n_layers; }
+    template<size_t I, typename Layer>
+    using slot_t = std::conditional_t<bucketed(I), std::array<Layer, OutputBuckets::N>, Layer>;
+  };
+
+  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, typename OutputBuckets, size_t... LayerSizes>
+  class QuantizedNetwork;
+
+  // The last OutputBuckets::depth layers have a copy for each of the OutputBuckets::N buckets.
+  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, typename OutputBuckets, size_t... LayerSizes>
+  class BucketedNetwork {
+  private:
+    using shape = LayerShape<OutputBuckets, AccumulatorSize, LayerSizes...>;
+
+  public:
+    using quantized_t = QuantizedNetwork<FeaturesSize, AccumulatorSize, AccumulatorShift, OutputBuckets, LayerSizes...>;
+    using output_buckets = OutputBuckets;
+    static constexpr size_t n_layers = sizeof...(LayerSizes);
+    template<size_t I>
+    using layer_t = LinearLayer<nn_t, shape::sizes[I], shape::sizes[I + 1]>;
+    static constexpr bool bucketed(const size_t I) { return shape::bucketed(I); }
+
+  private:
+    template<size_t... I>
+    static auto layer_types(std::index_sequence<I...>)
+      -> std::tuple<typename shape::template slot_t<I, std::unique_ptr<layer_t<I>>>...>;
     // Tuple of all the layers, excluding the accumulator layer
-    using Layers = typename LayerTypes<AccumulatorSize, LayerSizes...>::type;
+    using Layers = decltype(layer_types(std::make_index_sequence<n_layers>{}));
 
     // Helper for recursive forward pass
     template<size_t I = 0>
-    auto forward_impl(const auto& input) const {
-        if constexpr (I == sizeof...(LayerSizes) - 1) {
+    auto forward_impl(const auto& input, const size_t bucket) const {
+        if constexpr (I == n_layers - 1) {
             // Base case - last layer
-            return std::get<I>(layers)->forward(input);
+            return layer<I>(bucket).forward(input);
         } else {
             // Recursive case - apply layer, relu, then continue
-            return forward_impl<I + 1>(relu(std::get<I>(layers)->forward(input)));
+            return forward_impl<I + 1>(relu(layer<I>(bucket).forward(input)), bucket);
         }
     }
 
     public:
       Layers layers;
 
-      nn_t forward(const Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift>& accm, Colour us) const {
+      // The bucket is only used by the bucketed layers, and picked by OutputBuckets::bucket() for the position.
+      template <size_t KingBuckets>
+      nn_t forward(const Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift, KingBuckets>& accm, Colour us,
+                   const size_t bucket = 0) const {
         auto input = accm.template get_as<nn_t>(us);
-        return forward_impl(relu(input))[0];  // [0] since final layer outputs size-1 vector
+        return forward_impl(relu(input), bucket)[0];  // [0] since final layer outputs size-1 vector
     }
 
+    // Layer I, or its copy for the bucket.
     template<size_t I>
-    void set_layer(std::unique_ptr<typename std::tuple_element_t<I, Layers>::element_type> layer) {
-      static_assert(I < sizeof...(LayerSizes), "Index out of bounds");
+    const layer_t<I>& layer(const size_t bucket = 0) const {
+      if constexpr (bucketed(I)) {
+        assert(bucket < OutputBuckets::N);
+        return *std::get<I>(layers)[bucket];
+      } else {
+        return *std::get<I>(layers);
+      }
+    }
+
+    template<size_t I>
+    void set_layer(std::unique_ptr<layer_t<I>> layer) {
+      static_assert(I < n_layers, "Index out of bounds");
+      static_assert(!bucketed(I), "Bucketed layers are set one bucket at a time");
       std::get<I>(layers) = std::move(layer);
     }
+
+    template<size_t I>
+    void set_layer(const size_t bucket, std::unique_ptr<layer_t<I>> layer) {
+      static_assert(I < n_layers, "Index out of bounds");
+      if constexpr (bucketed(I)) {
+        assert(bucket < OutputBuckets::N);
+        std::get<I>(layers)[bucket] = std::move(layer);
+      } else {
+        assert(bucket == 0);
+        std::get<I>(layers) = std::move(layer);
+      }
+    }
+  };
+
+  // A network without output buckets, as the generated weights.hpp declares it.
+  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, size_t... LayerSizes>
+  using Network = BucketedNetwork<FeaturesSize, AccumulatorSize, AccumulatorShift, PieceCountBuckets<1>, LayerSizes...>;
+
+  // The same network with integer-only hidden layers: the accumulator goes through a clipped ReLU to int8, the hidden
+  // layers are int8 x int8 -> int32 and the output layer has 16 bit weights. Built from the float network, which it
+  // matches as long as the activations stay in [0, 2).
+  template<size_t FeaturesSize, size_t AccumulatorSize, uint8_t AccumulatorShift, typename OutputBuckets, size_t... LayerSizes>
+  class QuantizedNetwork {
+  private:
+    using accumulator_t = Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift>;
+    using network_t = BucketedNetwork<FeaturesSize, AccumulatorSize, AccumulatorShift, OutputBuckets, LayerSizes...>;
+    using shape = LayerShape<OutputBuckets, AccumulatorSize, LayerSizes...>;
+    // Fractional bits of the accumulator values.
+    static constexpr uint8_t acc_shift = accumulator_t::acc_bits - AccumulatorShift;
+    static constexpr size_t n_layers = sizeof...(LayerSizes);
+
+    template<size_t I>
+    using layer_t = QuantizedLinearLayer<std::conditional_t<I == n_layers - 1, int16_t, int8_t>, shape::sizes[I],
+                                         shape::sizes[I + 1]>;
+    template<size_t... I>
+    static auto layer_types(std::index_sequence<I...>) -> std::tuple<typename shape::template slot_t<I, layer_t<I>>...>;
+    using Layers = decltype(layer_types(std::make_index_sequence<n_layers>{}));
+
+    template<size_t I>
+    static auto quantize_layer(const network_t& network) {
+      if constexpr (shape::bucketed(I)) {
+        std::array<layer_t<I>, OutputBuckets::N> copies;
+        for (size_t bucket = 0; bucket < OutputBuckets::N; bucket++) {
+          copies[bucket] = layer_t<I>(network.template layer<I>(bucket));
+        }
+        return copies;
+      } else {
+        return layer_t<I>(network.template layer<I>());
+      }
+    }
+
+    template<size_t... I>
+    QuantizedNetwork(const network_t& network, std::index_sequence<I...>)
+      : layers(quantize_layer<I>(network)...) {}
+
+    template<size_t I>
+    const layer_t<I>& layer(const size_t bucket) const {
+      if constexpr (shape::bucketed(I)) {
+        assert(bucket < OutputBuckets::N);
+        return std::get<I>(layers)[bucket];
+      } else {
+        return std::get<I>(layers);
+      }
+    }
+
+    template<size_t I = 0>
+    auto forward_impl(const auto& input, const size_t bucket) const {
+        auto output = layer<I>(bucket).forward(input);
+        if constexpr (I == n_layers - 1) {
+            return output;
+        } else {
+            return forward_impl<I + 1>(clipped_relu(output, layer<I>(bucket).out_shift()), bucket);
+        }
+    }
+
+  public:
+    Layers layers;
+
+    QuantizedNetwork() = default;
+    explicit QuantizedNetwork(const network_t& network)
+      : QuantizedNetwork(network, std::make_index_sequence<n_layers>{}) {}
+
+    template <size_t KingBuckets>
+    nn_t forward(const Accumulator<FeaturesSize, AccumulatorSize, AccumulatorShift, KingBuckets>& accm, Colour us,
+                 const size_t bucket = 0) const {
+        const auto& acc = accm.get(us);
+        Vector<int32_t, AccumulatorSize> raw;
+        for (size_t i = 0; i < AccumulatorSize; i++) {
+            raw[i] = acc[i].raw_value();
+        }
+        auto output = forward_impl(clipped_relu(raw, acc_shift), bucket)[0];
+        return std::ldexp(static_cast<nn_t>(output), -layer<n_layers - 1>(bucket).out_shift());
+    }
   };
 
 } // namespace Neural
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+/* Integer SIMD kernels for the accumulator and the quantized hidden layers.
+ * The instruction set is picked at compile time, from whatever TARGET_ARCH (or USE_AVX2) lets the compiler use. Each
+ * wider path lives in its own namespace so the tests can check it against the scalar one.
+ */
+#include <cstddef>
+#include <cstdint>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace Neural::simd {
+
+namespace scalar {
+inline void add(int16_t *acc, const int16_t *row, const size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        acc[i] += row[i];
+    }
+}
+
+inline void sub(int16_t *acc, const int16_t *row, const size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        acc[i] -= row[i];
+    }
+}
+
+// The dot product of unsigned 8 bit activations with signed 8 bit weights, summed in 32 bits.
+inline int32_t dot(const uint8_t *a, const int8_t *w, const size_t n) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += static_cast<int32_t>(a[i]) * static_cast<int32_t>(w[i]);
+    }
+    return sum;
+}
+} // namespace scalar
+
+#if defined(__SSE4_1__)
+namespace sse {
+constexpr size_t width = sizeof(__m128i) / sizeof(int16_t);
+
+inline void add(int16_t *acc, const int16_t *row, const size_t n) {
+    size_t i = 0;
+    for (; i + width <= n; i += width) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc + i));
+        const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(acc + i), _mm_add_epi16(a, r));
+    }
+    scalar::add(acc + i, row + i, n - i);
+}
+
+inline void sub(int16_t *acc, const int16_t *row, const size_t n) {
+    size_t i = 0;
+    for (; i + width <= n; i += width) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc + i));
+        const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(acc + i), _mm_sub_epi16(a, r));
+    }
+    scalar::sub(acc + i, row + i, n - i);
+}
+
+// maddubs sums adjacent pairs into saturating int16s, which can't saturate as long as the activations are at most 127.
+inline int32_t dot(const uint8_t *a, const int8_t *w, const size_t n) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 * width <= n; i += 2 * width) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        const __m128i vw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(va, vw), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum) + scalar::dot(a + i, w + i, n - i);
+}
+} // namespace sse
+#endif
+
+#if defined(__AVX2__)
+namespace avx2 {
+constexpr size_t width = sizeof(__m256i) / sizeof(int16_t);
+
+inline void add(int16_t *acc, const int16_t *row, const size_t n) {
+    size_t i = 0;
+    for (; i + width <= n; i += width) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc + i));
+        const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + i), _mm256_add_epi16(a, r));
+    }
+    scalar::add(acc + i, row + i, n - i);
+}
+
+inline void sub(int16_t *acc, const int16_t *row, const size_t n) {
+    size_t i = 0;
+    for (; i + width <= n; i += width) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc + i));
+        const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + i), _mm256_sub_epi16(a, r));
+    }
+    scalar::sub(acc + i, row + i, n - i);
+}
+
+inline int32_t dot(const uint8_t *a, const int8_t *w, const size_t n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 2 * width <= n; i += 2 * width) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        const __m256i vw = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(va, vw), ones));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half) + scalar::dot(a + i, w + i, n - i);
+}
+} // namespace avx2
+#endif
+
+// acc += row and acc -= row, on the widest registers available. Overflow wraps, as the scalar int16 arithmetic does.
+inline void add(int16_t *acc, const int16_t *row, const size_t n) {
+#if defined(__AVX2__)
+    avx2::add(acc, row, n);
+#elif defined(__SSE4_1__)
+    sse::add(acc, row, n);
+#else
+    scalar::add(acc, row, n);
+#endif
+}
+
+inline void sub(int16_t *acc, const int16_t *row, const size_t n) {
+#if defined(__AVX2__)
+    avx2::sub(acc, row, n);
+#elif defined(__SSE4_1__)
+    sse::sub(acc, row, n);
+#else
+    scalar::sub(acc, row, n);
+#endif
+}
+
+inline int32_t dot(const uint8_t *a, const int8_t *w, const size_t n) {
+#if defined(__AVX2__)
+    return avx2::dot(a, w, n);
+#elif defined(__SSE4_1__)
+    return sse::dot(a, w, n);
+#else
+    return scalar::dot(a, w, n);
+#endif
+}
+
+} // namespace Neural::simd
@@ -5,6 +5,7 @@
 #include "transposition.hpp"
 #include "types.hpp"
 #include <algorithm>
+#include <array>
 #include <assert.h>
 #include <iostream>
 
@@ -60,17 +61,17 @@ Bitboard get_smallest_attacker(Board &board, const Square origin, const Bitboard
 // Mask is a bitboard mask for pieces to consider in the evaluation.
 score_t see(Board &board, const Square target, Colour side, PieceType pt, Bitboard mask) {
     Bitboard smallest_atk = get_smallest_attacker(board, target, mask, side);
-    // Vector the the relative gain on the square for each iteration of exchanges.
-    std::vector<score_t> gain;
-    gain.reserve(16);
+    // The relative gain on the square for each iteration of exchanges. Every piece on the board can take part at most
+    // once, after the initial capture.
+    std::array<score_t, 33> gain;
     int depth = 1;
     score_t value = SEE::material[pt];
-    gain.push_back(value);
+    gain[0] = value;
     while (smallest_atk) {
         const Square atksq = lsb(smallest_atk);
         PieceType p = board.piece_type(atksq);
         value = SEE::material[p];
-        gain.push_back(value - gain.back());
+        gain[depth] = value - gain[depth - 1];
         // Remove the smallest attacker
         mask ^= smallest_atk;
         // Switch the sides
@@ -171,38 +172,58 @@ bool see(Board &board, const Move move, const int threshold) {
 } // namespace SEE
 
 namespace Ordering {
+namespace {
+constexpr int hash_score = 1000000;
+constexpr int killer_score = 200000;
+
+void score_capture(Board &board, Move &move) {
+    // Make sure to lookup and record the piece captured
+    const score_t see_score = SEE::see_capture(board, move);
+    move.score = see_score;
+    if (board.gives_check(move)) {
+        move.score += 5000;
+    }
+    if (see_score > 50) {
+        move.score += 400000;
+    } else if (see_score > -50) {
+        move.score += 150000;
+    } else {
+        move.score += -400000;
+    }
+}
+
+void score_quiet(Board &board, Move &move) {
+    if (move.is_promotion()) {
+        move.score = 100000 + SEE::material[get_promoted(move)];
+    } else {
+        move.score = std::min(Cache::history_table.probe(move), 100000u);
+        if (board.gives_check(move)) {
+            move.score += 100000;
+        }
+    }
+}
+
+void score_move(Board &board, Move &move, const KillerTableRow &killer_moves) {
+    if (move == killer_moves) {
+        move.score = killer_score;
+    } else if (move.is_capture()) {
+        score_capture(board, move);
+    } else {
+        score_quiet(board, move);
+    }
+}
+} // namespace
+
 void sort_moves(MoveList &legal_moves) { std::sort(legal_moves.begin(), legal_moves.end(), cmp); }
-void rank_and_sort_moves(Board &board, MoveList &legal_moves, const DenseMove hash_dmove) {
-    KillerTableRow killer_moves = Cache::killer_table.probe(board.ply());
+void rank_and_sort_moves(Board &board, MoveList &legal_moves, const DenseMove hash_dmove,
+                         const KillerTableRow &killer_moves) {
     for (Move &move : legal_moves) {
         if (move == hash_dmove) {
             // The search handles the hash move itself. Here we just make sure it doesn't end up in the final move
             // list.
-            move.score = 1000000;
-        } else if (move == killer_moves) {
-            move.score = 200000;
-        } else if (move.is_capture()) {
-            // Make sure to lookup and record the piece captured
-            const score_t see_score = SEE::see_capture(board, move);
-            move.score = see_score;
-            if (board.gives_check(move)) {
-                move.score += 5000;
-            }
-            if (see_score > 50) {
-                move.score += 400000;
-            } else if (see_score > -50) {
-                move.score += 150000;
-            } else {
-                move.score += -400000;
-            }
-        } else if (move.is_promotion()) {
-            move.score = 100000 + SEE::material[get_promoted(move)];
+            move.score = hash_score;
         } else {
-            // Quiet move.
-            move.score = std::min(Cache::history_table.probe(move), 100000u);
-            if (board.gives_check(move)) {
-                move.score += 100000;
-            }
+            score_move(board, move, killer_moves);
         }
     }
 
@@ -214,4 +235,159 @@ void rank_and_sort_moves(Board &board, MoveList &legal_moves, const DenseMove ha
     // Quiet moves, sorted by history heuristic
     // Captures with SEE < -50
 }
+
+MovePicker::MovePicker(Board &board, const KillerTableRow &killer_moves) : board(board), killer_moves(killer_moves) {
+    if (board.is_check()) {
+        // There are few enough evasions that they are all generated and scored together.
+        board.get_evasion_moves(moves);
+        stage = EVASIONS;
+    } else {
+        stage = CAPTURES_INIT;
+    }
+}
+
+void MovePicker::generate_captures() {
+    if (!captures_generated) {
+        board.get_capture_moves(moves);
+        captures_generated = true;
+    }
+}
+
+void MovePicker::generate_quiets() {
+    if (!quiets_generated) {
+        board.get_quiet_moves(quiets);
+        quiets_generated = true;
+    }
+}
+
+bool MovePicker::has_moves() {
+    if (stage == EVASIONS) {
+        return !moves.empty();
+    }
+    const Colour us = board.who_to_play();
+    const Square king = board.find_king(us);
+    if (Bitboards::attacks<KING>(board.pieces(), king) & ~board.pieces(us) & ~board.attacked()) {
+        return true;
+    }
+    generate_captures();
+    if (!moves.empty()) {
+        return true;
+    }
+    generate_quiets();
+    return !quiets.empty();
+}
+
+Move MovePicker::hash_move(const DenseMove hash_dmove) {
+    assert(index == 0 && (stage == CAPTURES_INIT || stage == EVASIONS));
+    if (hash_dmove == NULL_DMOVE) {
+        return NULL_MOVE;
+    }
+    // Only generate the stage the hash move would belong to, to check it's legal here.
+    if (stage == EVASIONS) {
+        _hash_move = unpack_move(hash_dmove, moves);
+    } else if (hash_dmove.type() & CAPTURE) {
+        generate_captures();
+        _hash_move = unpack_move(hash_dmove, moves);
+    } else {
+        generate_quiets();
+        _hash_move = unpack_move(hash_dmove, quiets);
+    }
+    return _hash_move;
+}
+
+void MovePicker::pick_best(MoveList &list, const size_t index) {
+    auto best = std::max_element(list.begin() + index, list.end(), [](const Move &m1, const Move &m2) {
+        return m1.score < m2.score;
+    });
+    std::iter_swap(list.begin() + index, best);
+}
+
+Move MovePicker::next() {
+    switch (stage) {
+    case CAPTURES_INIT:
+        generate_captures();
+        for (Move &move : moves) {
+            score_capture(board, move);
+        }
+        stage = GOOD_CAPTURES;
+        [[fallthrough]];
+    case GOOD_CAPTURES:
+        while (index < moves.size()) {
+            pick_best(moves, index);
+            if (moves[index].score < 0) {
+                // Only losing captures left, they go last.
+                break;
+            }
+            const Move move = moves[index++];
+            if (move != _hash_move) {
+                return move;
+            }
+        }
+        stage = KILLERS;
+        [[fallthrough]];
+    case KILLERS:
+        generate_quiets();
+        while (killer_index < n_krow) {
+            const DenseMove killer = killer_moves[killer_index++];
+            if (killer == NULL_DMOVE || killer == _hash_move) {
+                continue;
+            }
+            // The killer is only legal here if it's one of our quiet moves, hand it out now instead of later.
+            for (Move &move : quiets) {
+                if (move == killer) {
+                    const Move killer_move = move;
+                    move = quiets.back();
+                    quiets.pop_back();
+                    return killer_move;
+                }
+            }
+        }
+        stage = QUIETS_INIT;
+        [[fallthrough]];
+    case QUIETS_INIT:
+        for (Move &move : quiets) {
+            score_quiet(board, move);
+        }
+        sort_moves(quiets);
+        stage = QUIETS;
+        [[fallthrough]];
+    case QUIETS:
+        while (quiet_index < quiets.size()) {
+            const Move move = quiets[quiet_index++];
+            if (move != _hash_move) {
+                return move;
+            }
+        }
+        stage = BAD_CAPTURES;
+        [[fallthrough]];
+    case BAD_CAPTURES:
+        while (index < moves.size()) {
+            pick_best(moves, index);
+            const Move move = moves[index++];
+            if (move != _hash_move) {
+                return move;
+            }
+        }
+        stage = DONE;
+        return NULL_MOVE;
+    case EVASIONS:
+        if (index == 0) {
+            for (Move &move : moves) {
+                score_move(board, move, killer_moves);
+            }
+        }
+        while (index < moves.size()) {
+            pick_best(moves, index);
+            const Move move = moves[index++];
+            if (move != _hash_move) {
+                return move;
+            }
+        }
+        stage = DONE;
+        return NULL_MOVE;
+    case DONE:
+        return NULL_MOVE;
+    }
+    return NULL_MOVE;
+}
 } // namespace Ordering
\ No newline at end of file
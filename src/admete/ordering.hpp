@@ -3,7 +3,51 @@
 
 namespace Ordering {
 void sort_moves(MoveList &legal_moves);
-void rank_and_sort_moves(Board &board, MoveList &legal_moves, const DenseMove hash_dmove);
+void rank_and_sort_moves(Board &board, MoveList &legal_moves, const DenseMove hash_dmove,
+                         const KillerTableRow &killer_moves);
+
+// Hands out the moves for a node in stages, each stage is only generated and scored once the search gets to it. At a
+// cut node that fails high on the hash move or an early capture, the quiet moves are never looked at.
+// Move order is:
+// Hash move (taken with hash_move(), next() never returns it)
+// Captures with SEE > -50
+// Killer moves
+// Quiet moves, sorted by history heuristic
+// Captures with SEE < -50
+// In check, all the evasions are generated up front and handed out by score.
+// The killers are only read once the picker gets to them, so it should be given the node's own row rather than a copy.
+class MovePicker {
+  public:
+    MovePicker(Board &board, const KillerTableRow &killer_moves);
+    // In check with no evasions, the node is checkmate.
+    bool is_mate() const { return stage == EVASIONS && moves.empty(); }
+    // Whether there are any legal moves at all, so that no moves is checkmate or stalemate. Out of check, a safe king
+    // step answers it without generating anything, otherwise the captures and quiets are generated for later.
+    bool has_moves();
+    // Returns the hash move if it is legal in this position, otherwise NULL_MOVE. Call before the first next().
+    Move hash_move(const DenseMove hash_dmove);
+    // Returns the next move to search, or NULL_MOVE once they have all been handed out.
+    Move next();
+
+  private:
+    enum Stage { CAPTURES_INIT, GOOD_CAPTURES, KILLERS, QUIETS_INIT, QUIETS, BAD_CAPTURES, EVASIONS, DONE };
+    void generate_captures();
+    void generate_quiets();
+    // Swap the best scoring move in [index, end) into index.
+    static void pick_best(MoveList &list, const size_t index);
+
+    Board &board;
+    Stage stage;
+    Move _hash_move = NULL_MOVE;
+    const KillerTableRow &killer_moves;
+    size_t killer_index = 0;
+    MoveList moves;
+    MoveList quiets;
+    size_t index = 0;
+    size_t quiet_index = 0;
+    bool captures_generated = false;
+    bool quiets_generated = false;
+};
 } // namespace Ordering
 
 namespace SEE {
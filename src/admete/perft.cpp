@@ -7,7 +7,8 @@ namespace Search {
 
 unsigned long perft_bulk(depth_t depth, Board &board) {
 
-    std::vector<Move> legal_moves = board.get_moves();
+    MoveList legal_moves;
+    board.get_moves(legal_moves);
     if (depth == 1) {
         return legal_moves.size();
     }
@@ -23,7 +24,8 @@ unsigned long perft_bulk(depth_t depth, Board &board) {
 
 void perft_divide(depth_t depth, Board &board) {
     std::cout << "divide()" << std::endl;
-    std::vector<Move> legal_moves = board.get_moves();
+    MoveList legal_moves;
+    board.get_moves(legal_moves);
     unsigned long nodes = 0;
     unsigned long child_nodes;
     for (auto move : legal_moves) {
@@ -43,7 +45,8 @@ unsigned long perft(depth_t depth, Board &board) {
 
 unsigned long perft(depth_t depth, Board &board, SearchOptions &options) {
 
-    std::vector<Move> legal_moves = board.get_moves();
+    MoveList legal_moves;
+    board.get_moves(legal_moves);
     if (depth == 0) {
         return 1;
     }
@@ -9,6 +9,7 @@
 #include <chrono>
 #include <iostream>
 #include <math.h>
+#include <memory>
 #include <time.h>
 
 
@@ -17,8 +18,19 @@
 constexpr score_t aspration_windows[] = {30, 80, 200, 500};
 constexpr size_t n_aw = sizeof(aspration_windows) / sizeof(score_t);
 
+void Search::SearchStackEntry::store_killer(const Move move) {
+    // Only quiet moves are killers, and there's no point keeping duplicates.
+    if (move == NULL_MOVE || move.type != QUIETmv || move == killers) {
+        return;
+    }
+    killers[killer_index] = pack_move(move);
+    // Cycle through the slots, so the oldest killer is the one replaced.
+    killer_index = (killer_index + 1) % n_krow;
+}
+
 score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, unsigned int time_cutoff,
-                             const bool allow_cutoff, const bool allow_null, NodeType node, SearchOptions &options) {
+                             const bool allow_cutoff, const bool allow_null, NodeType node, SearchStackEntry *ss,
+                             SearchOptions &options) {
     /* Perform a null window 'scout' search on a subtree.
      * All nodes examined with this tree are not PV nodes (unless proven otherwise, when they should be re-searched)
      * Has bounds [alpha, alpha + 1]
@@ -35,14 +47,15 @@ score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, u
     // Try to prefetch the transposition table entry.
     Cache::transposition_table.prefetch(hash);
 
-    MoveList legal_moves = board.get_moves();
-    // Terminal node.
-    if (legal_moves.empty()) {
-        return Evaluation::terminal(board);
-    }
+    // Moves are only generated as they are needed, so whether there are any is left until after the cheap cutoffs.
+    Ordering::MovePicker picker(board, ss->killers);
 
-    // If this is a draw by repetition or insufficient material, return the drawn score.
+    // If this is a draw by repetition or insufficient material, return the drawn score. Checkmate on the move that
+    // would draw by the 50 move rule still counts, the evasions have already been generated to tell.
     if (board.is_draw()) {
+        if (board.is_check() && !picker.has_moves()) {
+            return Evaluation::terminal(board);
+        }
         return Evaluation::drawn_score(board);
     }
 
@@ -60,14 +73,17 @@ score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, u
         return -ply_to_mate_score(board.ply());
     }
 
-    // Max ply
-    if (board.ply() >= MAX_PLY) {
+    // Max ply, the board has no room in its history for another move.
+    if (board.ply() >= MAX_PLY - 1) {
         return Evaluation::eval(board);
     }
 
-    // Leaf node for main tree.
+    // Leaf node for main tree. The quiescence search only finds checkmate, so look for stalemate first.
     if (depth == 0) {
-        return quiesce(board, alpha, beta, options);
+        if (!picker.has_moves()) {
+            return Evaluation::terminal(board);
+        }
+        return quiesce(board, alpha, beta, ss, options);
     }
 
     // Lookup position in transposition table.
@@ -128,8 +144,13 @@ score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, u
         }
     }
 
+    // Terminal node. This has to be found before the pruning below scores the node from its static eval.
+    if (!picker.has_moves()) {
+        return Evaluation::terminal(board);
+    }
+
     // Check if we've passed our time cutoff
-    if (allow_cutoff && (options.nodes % (1<<5) == 0)) {
+    if (allow_cutoff && (options.get_nodes() % (1<<5) == 0)) {
         if (options.get_millis() > time_cutoff) {
             options.set_stop();
             return MAX_SCORE;
@@ -142,8 +163,9 @@ score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, u
         return MAX_SCORE;
     }
 
-    // Calculate the node evaluation heuristic.
-    const score_t node_eval = Evaluation::eval(board);
+    // Calculate the node evaluation heuristic, the table may already have it from the last time this node was searched.
+    const score_t node_eval = tthit.has_static_eval() ? tthit.static_eval() : Evaluation::eval(board);
+    ss->static_eval = node_eval;
 
     // Reverse futility pruning
     // Prune if this node is almost certain to fail high.
@@ -156,9 +178,11 @@ score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, u
     // Null move pruning.
     // Making a null move, in most cases, should be the worst option and give us an approximate lower bound on the score for this node.
     if (!board.is_endgame() && allow_null && (depth > null_move_depth_reduction) && !board.is_check()) {
+        ss->move = NULL_MOVE;
+        ss->reduction = null_move_depth_reduction;
         board.make_nullmove();
         score_t score = -scout_search(board, depth - 1 - null_move_depth_reduction, -beta, time_cutoff,
-                                      allow_cutoff, false, CUTNODE, options);
+                                      allow_cutoff, false, CUTNODE, ss + 1, options);
         board.unmake_nullmove();
         if (score >= beta) {
             // beta cutoff
@@ -171,21 +195,23 @@ score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, u
     // margin, then we can probably cut safely.
     if (depth >= probcut_min_depth && beta < TBWIN_MIN && beta > -TBWIN_MIN) {
         const score_t probcut_threshold = beta + probcut_margin;
-        const score_t probcut_score = scout_search(board, depth - probcut_depth_reduction, probcut_threshold - 1, time_cutoff, allow_cutoff, allow_null, node, options);
+        const score_t probcut_score = scout_search(board, depth - probcut_depth_reduction, probcut_threshold - 1, time_cutoff, allow_cutoff, allow_null, node, ss, options);
         if (probcut_score >= probcut_threshold) {
             return probcut_score;
         }
     }
 
     Move best_move = NULL_MOVE;
-    Move hash_move = unpack_move(hash_dmove, legal_moves);
+    Move hash_move = picker.hash_move(hash_dmove);
 
     // Do the hash move explicitly to avoid sorting moves if our hash moves provides a beta-cutoff
     if (hash_move != NULL_MOVE) {
+        ss->move = hash_move;
+        ss->reduction = 0;
         board.make_move(hash_move);
         // We expect first child of a cut node to be an all node, such that it would cause the cut node to fail high.
         best_score = -scout_search(board, depth - 1, -beta, time_cutoff, allow_cutoff, true,
-                                   node == CUTNODE ? ALLNODE : CUTNODE, options);
+                                   node == CUTNODE ? ALLNODE : CUTNODE, ss + 1, options);
         board.unmake_move(hash_move);
         best_move = hash_move;
 
@@ -194,21 +220,16 @@ score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, u
         }
 
         if (best_score >= beta) {
-            Cache::killer_table.store(board.ply(), best_move);
+            ss->store_killer(best_move);
             Cache::history_table.store(depth, best_move);
             best_score = std::min(best_score, score_ub);
-            Cache::transposition_table.store(hash, best_score, LOWER, depth, best_move, board.ply());
+            Cache::transposition_table.store(hash, best_score, LOWER, depth, best_move, board.ply(), node_eval);
             return best_score;
         }
     }
 
-    Ordering::rank_and_sort_moves(board, legal_moves, hash_dmove);
     uint counter = 0;
-    for (Move move : legal_moves) {
-        // We've already dealt with the hashmove.
-        if (move == hash_move) {
-            continue;
-        }
+    for (Move move = picker.next(); move != NULL_MOVE; move = picker.next()) {
         counter++;
         const bool gives_check = board.gives_check(move);
         if ((node == CUTNODE) && (counter >= 5)) {
@@ -262,12 +283,16 @@ score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, u
 
         search_depth = std::clamp(search_depth, (depth_t)0, (depth_t)(depth - 1));
 
+        ss->move = move;
+        ss->reduction = depth - 1 - search_depth;
         board.make_move(move);
-        score_t score = -scout_search(board, search_depth, -beta, time_cutoff, allow_cutoff, true, child, options);
+        score_t score =
+            -scout_search(board, search_depth, -beta, time_cutoff, allow_cutoff, true, child, ss + 1, options);
         // If our search at lower depth did raise alpha, and this is an All node, re-search at full depth before failing
         // high.
-        if ((node == ALLNODE) && (score > alpha) && (search_depth < depth - 1)) {
-            score = -scout_search(board, depth - 1, -beta, time_cutoff, allow_cutoff, true, child, options);
+        if ((node == ALLNODE) && (score > alpha) && (ss->reduction > 0)) {
+            ss->reduction = 0;
+            score = -scout_search(board, depth - 1, -beta, time_cutoff, allow_cutoff, true, child, ss + 1, options);
         }
 
         board.unmake_move(move);
@@ -280,27 +305,30 @@ score_t Search::scout_search(Board &board, depth_t depth, const score_t alpha, u
         }
         if (best_score >= beta) {
             // beta-cutoff
-            Cache::killer_table.store(board.ply(), best_move);
+            ss->store_killer(best_move);
             Cache::history_table.store(depth, best_move);
             break;
         }
     }
     best_score = std::min(best_score, score_ub);
     const Bounds bound = best_score <= alpha ? UPPER : best_score >= beta ? LOWER : EXACT;
-    Cache::transposition_table.store(hash, best_score, bound, depth, best_move, board.ply());
+    Cache::transposition_table.store(hash, best_score, bound, depth, best_move, board.ply(), node_eval);
     return best_score;
 }
 
 score_t Search::pv_search(Board &board, const depth_t start_depth, const score_t alpha_start, const score_t beta,
-                          PrincipleLine &line, unsigned int time_cutoff, const bool allow_cutoff,
+                          unsigned int time_cutoff, const bool allow_cutoff, SearchStackEntry *ss,
                           SearchOptions &options) {
     // Perform an alpha-beta pruning tree search.
     // The use of this function implies that the node is a PV-node.
     // For non-PV nodes, use scout_search.
     // Has bounds [alpha, beta]
+    // The principle variation from this node is left in the pv_table, at this node's height.
 
     score_t alpha = alpha_start;
     depth_t depth = start_depth;
+    const ply_t height = board.height();
+    pv_table.clear(height);
 
     // Check extentions
     if (board.is_check()) {
@@ -309,25 +337,28 @@ score_t Search::pv_search(Board &board, const depth_t start_depth, const score_t
     const zobrist_t hash = board.hash();
     Cache::transposition_table.prefetch(hash);
 
-    MoveList legal_moves = board.get_moves();
-    // Terminal node
-    if (legal_moves.empty()) {
-        return Evaluation::terminal(board);
-    }
+    Ordering::MovePicker picker(board, ss->killers);
 
-    // Probe the tablebase for the winning move at root.
-    if (options.tbenable && board.is_root()) {
-        if (Tablebase::probe_root(board, legal_moves)) {
+    // Probe the tablebase for the winning move at root. Root probes aren't thread safe, so leave it to the main thread.
+    if (options.tbenable && board.is_root() && options.thread_id == 0) {
+        MoveList legal_moves;
+        board.get_moves(legal_moves);
+        if (!legal_moves.empty() && Tablebase::probe_root(board, legal_moves)) {
             assert(!legal_moves.empty());
             options.tbhits++;
             // Only move in legal_moves will be the best move from the tablebase. Its score is set to the eval.
-            line.push_back(legal_moves.front());
+            pv_table.clear(height + 1);
+            pv_table.update(height, legal_moves.front());
             return legal_moves.front().score;
         }
     }
 
-    // If this is a draw by repetition, 50 moves, or insufficient material, return the drawn score.
+    // If this is a draw by repetition, 50 moves, or insufficient material, return the drawn score. Checkmate on the move
+    // that would draw by the 50 move rule still counts.
     if (board.is_draw() && !board.is_root()) {
+        if (board.is_check() && !picker.has_moves()) {
+            return Evaluation::terminal(board);
+        }
         return Evaluation::drawn_score(board);
     }
 
@@ -346,14 +377,19 @@ score_t Search::pv_search(Board &board, const depth_t start_depth, const score_t
         return -ply_to_mate_score(board.ply());
     }
 
-    // Max ply
-    if (board.ply() >= MAX_PLY) {
+    // Max ply, the board has no room in its history for another move.
+    if (board.ply() >= MAX_PLY - 1) {
         return Evaluation::eval(board);
     }
 
+    // Terminal node. There are no cutoffs to save the move generation for at a PV node.
+    if (!picker.has_moves()) {
+        return Evaluation::terminal(board);
+    }
+
     // Leaf node for the main tree.
     if (depth == 0) {
-        return quiesce(board, alpha, beta, options);
+        return quiesce(board, alpha, beta, ss, options);
     }
 
     // Lookup position in transposition table for hashmove.
@@ -364,7 +400,7 @@ score_t Search::pv_search(Board &board, const depth_t start_depth, const score_t
     }
 
     // Check if we've passed our time cutoff
-    if (allow_cutoff && (options.nodes % (1<<5) == 0)) {
+    if (allow_cutoff && (options.get_nodes() % (1<<5) == 0)) {
         if (options.get_millis() > time_cutoff) {
             options.set_stop();
             return MAX_SCORE;
@@ -412,53 +448,56 @@ score_t Search::pv_search(Board &board, const depth_t start_depth, const score_t
         }
     }
 
+    // PV nodes don't prune, so they never need the static eval, and their moves are never reduced.
+    ss->static_eval = MIN_SCORE;
+    ss->reduction = 0;
+
     bool is_first_child = true;
-    PrincipleLine pv;
-    Move hash_move = unpack_move(hash_dmove, legal_moves);
+    Move best_move = NULL_MOVE;
+    Move hash_move = picker.hash_move(hash_dmove);
 
     // Do the hash move explicitly to avoid sorting moves if our hash moves provides a beta-cutoff
     if (hash_move != NULL_MOVE) {
+        ss->move = hash_move;
         board.make_move(hash_move);
-        score_t score = -pv_search(board, depth - 1, -beta, -alpha, pv, time_cutoff, allow_cutoff, options);
+        score_t score = -pv_search(board, depth - 1, -beta, -alpha, time_cutoff, allow_cutoff, ss + 1, options);
         board.unmake_move(hash_move);
-        pv.push_back(hash_move);
 
         if (options.stop()) {
             return MAX_SCORE;
         }
+        best_move = hash_move;
+        pv_table.update(height, best_move);
         best_score = std::max(best_score, score);
         alpha = std::max(alpha, score);
         if (alpha >= beta) {
-            line = pv;
-            Cache::killer_table.store(board.ply(), pv.back());
-            Cache::history_table.store(depth, pv.back());
+            ss->store_killer(best_move);
+            Cache::history_table.store(depth, best_move);
             best_score = std::min(best_score, score_ub);
-            Cache::transposition_table.store(hash, best_score, LOWER, depth, pv.back(), board.ply());
+            Cache::transposition_table.store(hash, best_score, LOWER, depth, best_move, board.ply());
             return best_score;
         }
         is_first_child = false;
     }
-    // Sort the remaining moves, and remove the hash move if it exists
-    Ordering::rank_and_sort_moves(board, legal_moves, hash_dmove);
-
-    for (Move move : legal_moves) {
-        // We've already dealt with the hashmove.
-        if (move == hash_move) {
-            continue;
-        }
-        PrincipleLine temp_line;
-        temp_line.reserve(16);
+    // The picker hands out the rest of the moves, it never returns the hash move.
+    uint counter = 0;
+    for (Move move = picker.next(); move != NULL_MOVE; move = picker.next()) {
+        counter++;
+        // A child that only gets a scout search leaves no line behind, so don't pick up one from an earlier sibling.
+        pv_table.clear(height + 1);
 
+        ss->move = move;
         board.make_move(move);
         score_t score;
         if (is_first_child) {
-            score = -pv_search(board, depth - 1, -beta, -alpha, temp_line, time_cutoff, allow_cutoff, options);
+            score = -pv_search(board, depth - 1, -beta, -alpha, time_cutoff, allow_cutoff, ss + 1, options);
         } else {
             // Search with a null window
-            score = -scout_search(board, depth - 1, -alpha - 1, time_cutoff, allow_cutoff, true, CUTNODE, options);
+            score = -scout_search(board, depth - 1, -alpha - 1, time_cutoff, allow_cutoff, true, CUTNODE, ss + 1,
+                                  options);
             if (score > alpha && score < beta) {
                 // Do a full search
-                score = -pv_search(board, depth - 1, -beta, -alpha, temp_line, time_cutoff, allow_cutoff, options);
+                score = -pv_search(board, depth - 1, -beta, -alpha, time_cutoff, allow_cutoff, ss + 1, options);
             }
         }
         board.unmake_move(move);
@@ -469,27 +508,27 @@ score_t Search::pv_search(Board &board, const depth_t start_depth, const score_t
 
         if (score > best_score) {
             best_score = score;
-            pv = temp_line;
-            pv.push_back(move);
+            best_move = move;
+            pv_table.update(height, best_move);
         }
         alpha = std::max(alpha, score);
         if (alpha >= beta) {
-            Cache::killer_table.store(board.ply(), pv.back());
+            ss->store_killer(best_move);
             Cache::history_table.store(depth, move);
             break; // beta-cutoff
         }
         is_first_child = false;
     }
-    line = pv;
-    if (!pv.empty()) {
+    if (best_move != NULL_MOVE) {
         best_score = std::min(best_score, score_ub);
         const Bounds bound = best_score <= alpha_start ? UPPER : best_score >= beta ? LOWER : EXACT;
-        Cache::transposition_table.store(hash, best_score, bound, depth, pv.back(), board.ply());
+        Cache::transposition_table.store(hash, best_score, bound, depth, best_move, board.ply());
     }
     return best_score;
 }
 
-score_t Search::quiesce(Board &board, const score_t alpha_start, const score_t beta, SearchOptions &options) {
+score_t Search::quiesce(Board &board, const score_t alpha_start, const score_t beta, SearchStackEntry *ss,
+                        SearchOptions &options) {
     // perform quiesence search to evaluate only quiet positions.
     score_t alpha = alpha_start;
 
@@ -498,7 +537,7 @@ score_t Search::quiesce(Board &board, const score_t alpha_start, const score_t b
     // Look for checkmate
     if (board.is_check()) {
         // Generates all evasions.
-        moves = board.get_moves();
+        board.get_moves(moves);
         if (moves.empty()) {
             return Evaluation::terminal(board);
         }
@@ -509,9 +548,15 @@ score_t Search::quiesce(Board &board, const score_t alpha_start, const score_t b
         return Evaluation::drawn_score(board);
     }
 
-    options.nodes++;
+    // Max ply, the board has no room in its history for another move.
+    if (board.ply() >= MAX_PLY - 1) {
+        return Evaluation::eval(board);
+    }
+
+    options.increment_nodes();
 
     const score_t stand_pat = Evaluation::eval(board);
+    ss->static_eval = stand_pat;
 
     alpha = std::max(alpha, stand_pat);
 
@@ -533,7 +578,7 @@ score_t Search::quiesce(Board &board, const score_t alpha_start, const score_t b
     // Get a list of moves for quiessence. If it's check, it we already have all evasions from the checkmate test.
     // Not in check, we generate quiet checks and all captures.
     if (!board.is_check()) {
-        moves = board.get_capture_moves();
+        board.get_capture_moves(moves);
     }
 
     // We already know it's not mate, if there are no captures in a position, return stand pat.
@@ -542,7 +587,7 @@ score_t Search::quiesce(Board &board, const score_t alpha_start, const score_t b
     }
 
     // Sort the captures and record SEE.
-    Ordering::rank_and_sort_moves(board, moves, NULL_DMOVE);
+    Ordering::rank_and_sort_moves(board, moves, NULL_DMOVE, ss->killers);
 
     for (Move move : moves) {
         // For a capture, the recorded score is the SEE value.
@@ -555,8 +600,9 @@ score_t Search::quiesce(Board &board, const score_t alpha_start, const score_t b
         if (!board.is_check() && move.is_capture() && !SEE::see(board, move, alpha - stand_pat - see_margin)) {
             continue;
         }
+        ss->move = move;
         board.make_move(move);
-        const score_t score = -quiesce(board, -beta, -alpha, options);
+        const score_t score = -quiesce(board, -beta, -alpha, ss + 1, options);
         board.unmake_move(move);
         alpha = std::max(alpha, score);
         if (alpha >= beta) {
@@ -566,13 +612,28 @@ score_t Search::quiesce(Board &board, const score_t alpha_start, const score_t b
     return alpha;
 }
 
-score_t Search::search(Board &board, const depth_t max_depth, int soft_cutoff, const int hard_cutoff,
-                       PrincipleLine &line, SearchOptions &options) {
-    // Initialise the transposition table.
-    Cache::transposition_table.set_delete();
+namespace Search {
+// A Lazy SMP helper. It searches the same root on its own copy of the board, and only shares the transposition table
+// with the other threads.
+struct HelperThread {
+    HelperThread(const Board &root) : board(root) {}
+    Board board;
+    SearchOptions options;
+    PrincipleLine line;
+    std::thread thread;
+};
+typedef std::vector<std::unique_ptr<HelperThread>> HelperList;
+
+score_t iterative_deepening(Board &board, const depth_t max_depth, int soft_cutoff, const int hard_cutoff,
+                            PrincipleLine &line, SearchOptions &options, const HelperList &helpers);
+} // namespace Search
+
+score_t Search::iterative_deepening(Board &board, const depth_t max_depth, int soft_cutoff, const int hard_cutoff,
+                                    PrincipleLine &line, SearchOptions &options, const HelperList &helpers) {
     Cache::history_table.clear();
+    SearchStack stack;
     PrincipleLine principle;
-    board.set_root();
+    const bool is_main = options.thread_id == 0;
 
     const ply_t mate_in_ply = 2 * options.mate_depth;
 
@@ -587,12 +648,15 @@ score_t Search::search(Board &board, const depth_t max_depth, int soft_cutoff, c
     bool allow_cutoff = false;
     options.tbhits = 0;
     options.nodes = 0;
+    // Each go starts fresh search threads, so their eval caches start out empty. search() can also be called from a
+    // thread that has evaluated before (the tests, bench), so only count this search's lookups.
+    const uint64_t evalprobes_start = Cache::eval_cache.probes();
+    const uint64_t evalhits_start = Cache::eval_cache.hits();
 
     Move last_best_move = NULL_MOVE;
     // Iterative deepening
-    for (depth_t depth = 2; depth <= max_depth; depth++) {
-        PrincipleLine temp_line;
-        temp_line.reserve(depth);
+    // Helpers with an odd index skip the first iteration, so that the threads aren't all searching the same depth.
+    for (depth_t depth = 2 + (options.thread_id % 2); depth <= max_depth; depth++) {
         score_t new_score;
 
         // Aspiration windows.
@@ -600,8 +664,8 @@ score_t Search::search(Board &board, const depth_t max_depth, int soft_cutoff, c
         score_t alpha = score - aspration_windows[0];
         score_t beta = score + aspration_windows[0];
         for (size_t aw = 0; aw <= n_aw; aw++) {
-            temp_line.clear();
-            new_score = pv_search(board, depth, alpha, beta, temp_line, hard_cutoff, allow_cutoff, options);
+            new_score = pv_search(board, depth, alpha, beta, hard_cutoff, allow_cutoff, &stack[search_stack_offset],
+                                  options);
 
             // Exit search if we've been asked to stop.
             if (options.stop()) {
@@ -648,23 +712,32 @@ score_t Search::search(Board &board, const depth_t max_depth, int soft_cutoff, c
         // Score is saved to temporary variable new_score so that we still have the last valid score if the search is
         // stopped by force.
         score = new_score;
-        principle = temp_line;
+        principle = pv_table.line();
+
+        // Helpers just keep searching until they are told to stop.
+        if (!is_main) {
+            continue;
+        }
 
         // Calculate the time spent so far.
         millis_now = 1 + options.get_millis();
-        const uint64_t nps = ((uint64_t)1000 * options.nodes) / millis_now;
+        uint64_t nodes = options.get_nodes();
+        for (const auto &helper : helpers) {
+            nodes += helper->options.get_nodes();
+        }
+        const uint64_t nps = ((uint64_t)1000 * nodes) / millis_now;
 
         // Send the info for the search to uci
-        UCI::uci_info(depth, score, options.nodes, options.tbhits, nps, principle, millis_now, board.get_root());
+        UCI::uci_info(depth, score, nodes, options.tbhits, nps, principle, millis_now, board.get_root());
 
         // Estimate the next time span.
         millis_next = branching_factor * millis_now;
 
         // In simple positions, reduce our thinking time.
-        if (principle.back() == last_best_move) {
+        if (principle.empty() || principle.front() == last_best_move) {
             soft_cutoff -= soft_cutoff / 10;
         } else {
-            last_best_move = principle.back();
+            last_best_move = principle.front();
         }
         // Check if our estimate of the next depth will take us over our time limit.
         if (millis_next > hard_cutoff) {
@@ -690,10 +763,52 @@ score_t Search::search(Board &board, const depth_t max_depth, int soft_cutoff, c
 
         millis_last = millis_now;
     }
+    options.evalprobes = Cache::eval_cache.probes() - evalprobes_start;
+    options.evalhits = Cache::eval_cache.hits() - evalhits_start;
     line = principle;
     return score;
 }
 
+score_t Search::search(Board &board, const depth_t max_depth, int soft_cutoff, const int hard_cutoff,
+                       PrincipleLine &line, SearchOptions &options) {
+    // Age the transposition table, making sure it has finished being set up.
+    Cache::transposition_table.wait();
+    Cache::transposition_table.new_search();
+    board.set_root();
+
+    // Start the helper threads, each on a copy of the root position. They count towards the node limit too.
+    options.search_nodes = 0;
+    HelperList helpers;
+    for (unsigned i = 1; i < n_threads; i++) {
+        auto helper = std::make_unique<HelperThread>(board);
+        helper->options.thread_id = i;
+        helper->options.main_options = &options;
+        helper->options.max_nodes = options.max_nodes;
+        helper->options.tbenable = options.tbenable;
+        helper->options.mate_depth = options.mate_depth;
+        HelperThread *h = helper.get();
+        helper->thread = std::thread([h, max_depth]() {
+            iterative_deepening(h->board, max_depth, POS_INF, POS_INF, h->line, h->options, HelperList());
+        });
+        helpers.push_back(std::move(helper));
+    }
+
+    const score_t score = iterative_deepening(board, max_depth, soft_cutoff, hard_cutoff, line, options, helpers);
+
+    // The main thread has finished, so the helpers' results are no longer needed.
+    for (auto &helper : helpers) {
+        helper->options.set_stop();
+    }
+    for (auto &helper : helpers) {
+        helper->thread.join();
+        options.nodes += helper->options.get_nodes();
+        options.tbhits += helper->options.tbhits;
+        options.evalprobes += helper->options.evalprobes;
+        options.evalhits += helper->options.evalhits;
+    }
+    return score;
+}
+
 score_t Search::search(Board &board, const depth_t depth, PrincipleLine &line) {
     SearchOptions options = SearchOptions();
     return search(board, depth, POS_INF, POS_INF, line, options);
@@ -711,7 +826,7 @@ Position board_quiesce(Board &board, const score_t alpha_start, const score_t be
     // Look for checkmate
     if (board.is_check()) {
         // Generates all evasions.
-        moves = board.get_moves();
+        board.get_moves(moves);
         if (moves.empty()) {
             qp.second = Evaluation::terminal(board);
             return qp;
@@ -748,7 +863,7 @@ Position board_quiesce(Board &board, const score_t alpha_start, const score_t be
     // Get a list of moves for quiessence. If it's check, it we already have all evasions from the checkmate test.
     // Not in check, we generate quiet checks and all captures.
     if (!board.is_check()) {
-        moves = board.get_capture_moves();
+        board.get_capture_moves(moves);
     }
 
     // We already know it's not mate, if there are no captures in a position, return stand pat.
@@ -758,7 +873,7 @@ Position board_quiesce(Board &board, const score_t alpha_start, const score_t be
     }
 
     // Sort the captures and record SEE.
-    Ordering::rank_and_sort_moves(board, moves, NULL_DMOVE);
+    Ordering::rank_and_sort_moves(board, moves, NULL_DMOVE, NULL_KROW);
 
     for (Move move : moves) {
         // For a capture, the recorded score is the SEE value.
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <thread>
 
+// The principle variation, from the root move onwards.
 typedef std::vector<Move> PrincipleLine;
 
 typedef std::chrono::steady_clock my_clock;
@@ -21,13 +22,20 @@ struct SearchOptions {
     }
     std::atomic<bool> stop_flag;    // Flag to use to tell the search to stop as soon as possible
     score_t eval = MIN_SCORE;       // Where the eval is set when the object is shared between threads.
-    uint64_t nodes = 0;             // How many nodes have been accessed
-    uint64_t max_nodes = 0;         // Maximum number of nodes to search
+    std::atomic<uint64_t> nodes = 0; // How many nodes have been accessed, read by the main thread for the total.
+    uint64_t max_nodes = 0;         // Maximum number of nodes to search, over all of the threads.
+    // Nodes searched by every thread, which the node limit is checked against. It is kept on the main thread's options,
+    // and each thread adds to it in batches so they don't all contend for it on every node.
+    std::atomic<uint64_t> search_nodes = 0;
+    SearchOptions *main_options = this;
     std::thread running_thread;     // The thread object for the search itself.
     std::atomic<bool> running_flag; // Flag set when the search is running.
     ply_t mate_depth = 0;           // Mate in N distance to look for UCI go mate N commands.
     bool tbenable = false;          // Set true if the tablebase is enabled.
     uint64_t tbhits = 0;
+    uint64_t evalprobes = 0;          // Eval cache lookups during the search, summed over the threads.
+    uint64_t evalhits = 0;
+    unsigned thread_id = 0;           // Index of the search thread, 0 is the main thread.
     my_clock::time_point origin_time; // Time At start of search.
     bool is_running() const { return running_flag.load(); }
     bool stop() const { return stop_flag.load(); }
@@ -36,17 +44,82 @@ struct SearchOptions {
     unsigned get_millis() {
         return 1 + std::chrono::duration_cast<std::chrono::milliseconds>(my_clock::now() - origin_time).count();
     }
+    static constexpr uint64_t node_batch = 1 << 10;
+    // Only the owning thread writes the node count, so it doesn't need an atomic increment.
+    void increment_nodes() {
+        const uint64_t count = nodes.load(std::memory_order_relaxed) + 1;
+        nodes.store(count, std::memory_order_relaxed);
+        if (count % node_batch == 0) {
+            main_options->search_nodes.fetch_add(node_batch, std::memory_order_relaxed);
+        }
+    }
+    uint64_t get_nodes() const { return nodes.load(std::memory_order_relaxed); }
     bool check_nodes_and_increment() {
-        nodes++;
-        return (max_nodes > 0) && (nodes >= max_nodes);
+        increment_nodes();
+        // This thread's nodes since its last batch haven't been added yet.
+        return (max_nodes > 0) &&
+               (main_options->search_nodes.load(std::memory_order_relaxed) + get_nodes() % node_batch >= max_nodes);
     }
     // bool passed_time() { return (get_millis() > hard_cutoff); }
 };
+// Triangular table of principle variations, indexed by height from the root. Row h holds the line from the PV node at
+// height h in columns [h, length[h]), which is its best move followed by row h + 1. Lines deeper than the table are
+// cut short.
+class PvTable {
+  public:
+    // Start an empty line at this height.
+    void clear(const ply_t height) {
+        if (height < size) {
+            length[height] = height;
+        }
+    }
+    // The line at this height becomes move, followed by the line left by the child at height + 1.
+    void update(const ply_t height, const Move move) {
+        if (height >= size) {
+            return;
+        }
+        moves[height][height] = move;
+        const ply_t end = height + 1 < size ? length[height + 1] : height + 1;
+        for (ply_t i = height + 1; i < end; i++) {
+            moves[height][i] = moves[height + 1][i];
+        }
+        length[height] = end;
+    }
+    // The line from the root.
+    PrincipleLine line() const { return PrincipleLine(moves[0].begin(), moves[0].begin() + length[0]); }
+
+  private:
+    static constexpr ply_t size = MAX_DEPTH;
+    std::array<ply_t, size> length = {};
+    std::array<std::array<Move, size>, size> moves;
+};
+
+// Each search thread keeps its own principle variations.
+inline thread_local PvTable pv_table;
+
+// The state a search thread keeps for each node on the current line, indexed by height from the root. A node works on
+// its own entry, ss, and can look back at its ancestors' (ss - 1, ss - 2) while its children get ss + 1.
+struct SearchStackEntry {
+    score_t static_eval = MIN_SCORE; // Static eval of the node, MIN_SCORE when it wasn't needed (PV nodes).
+    Move move = NULL_MOVE;           // The move currently being searched from this node, NULL_MOVE for a null move.
+    depth_t reduction = 0;           // How much that move's search is reduced by.
+    // Quiet moves that caused a cutoff at this height. The entries are kept between iterations, so the killers carry
+    // over to the next depth.
+    KillerTableRow killers = NULL_KROW;
+    uint8_t killer_index = 0;
+    void store_killer(const Move move);
+};
+// A couple of entries sit below the root, so looking back from near the root needs no bounds checks. The search stops
+// at MAX_PLY, which bounds the height.
+constexpr size_t search_stack_offset = 2;
+typedef std::array<SearchStackEntry, search_stack_offset + MAX_PLY + 1> SearchStack;
+
 score_t scout_search(Board &board, depth_t depth, const score_t alpha, unsigned int time_cutoff,
-                     const bool allow_cutoff, const bool allow_null, NodeType node, SearchOptions &options);
-score_t pv_search(Board &board, depth_t depth, const score_t alpha, const score_t beta, PrincipleLine &line,
-                  unsigned int time_cutoff, const bool allow_cutoff, SearchOptions &options);
-score_t quiesce(Board &board, score_t alpha, const score_t beta, SearchOptions &options);
+                     const bool allow_cutoff, const bool allow_null, NodeType node, SearchStackEntry *ss,
+                     SearchOptions &options);
+score_t pv_search(Board &board, depth_t depth, const score_t alpha, const score_t beta, unsigned int time_cutoff,
+                  const bool allow_cutoff, SearchStackEntry *ss, SearchOptions &options);
+score_t quiesce(Board &board, score_t alpha, const score_t beta, SearchStackEntry *ss, SearchOptions &options);
 score_t search(Board &board, const depth_t depth, int soft_cutoff, const int hard_cutoff, PrincipleLine &line,
                SearchOptions &options);
 score_t search(Board &board, const depth_t depth, PrincipleLine &line);
@@ -57,6 +130,12 @@ unsigned long perft(depth_t depth, Board &board, SearchOptions &options);
 unsigned long perft_bulk(depth_t depth, Board &board);
 void perft_divide(depth_t depth, Board &board);
 
+// Lazy SMP, number of threads searching the root.
+constexpr unsigned threads_default = 1u;
+constexpr unsigned threads_min = 1u;
+constexpr unsigned threads_max = 256u;
+inline unsigned n_threads = threads_default;
+
 // Search parameters
 #ifdef WITH_TUNING
 #define PARAMETER inline
@@ -3,29 +3,213 @@
 #include <array>
 #include <assert.h>
 #include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
 #if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
 #include <xmmintrin.h>
 #endif
+#if defined(_WIN32)
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr size_t large_page_size = 2 * 1024 * 1024;
+
+void *alloc_aligned(const size_t alignment, const size_t size) {
+    // Round up, std::aligned_alloc needs the size to be a multiple of the alignment.
+    const size_t alloc_size = ((size + alignment - 1) / alignment) * alignment;
+#if defined(_WIN32)
+    return _aligned_malloc(alloc_size, alignment);
+#else
+    return std::aligned_alloc(alignment, alloc_size);
+#endif
+}
+
+void *large_page_alloc(const size_t size) {
+    void *ptr = alloc_aligned(large_page_size, size);
+    if (ptr == nullptr) {
+        // Fall back to plain cache line alignment.
+        ptr = alloc_aligned(alignof(Cache::TransBucket), size);
+    }
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+#if defined(MADV_HUGEPAGE)
+    // Only a hint, if transparent huge pages are disabled we just get normal pages.
+    madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    return ptr;
+}
+
+struct SnapshotHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t bucket_bytes;
+    uint64_t n_buckets;
+    uint8_t generation;
+};
+static_assert(sizeof(SnapshotHeader) <= Cache::snapshot_header_size);
+} // namespace
+
+void Cache::LargePageDeleter::operator()(TransBucket *ptr) const {
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    if (mapped != nullptr) {
+        munmap(mapped, mapped_size);
+    } else {
+        std::free(ptr);
+    }
+#endif
+}
 
 Cache::TranspositionTable::TranspositionTable() {
-    // Limit our index to a power of two.
-    max_index = std::bit_floor(Cache::tt_max);
+    resize(Cache::tt_max);
+    wait();
+}
+
+void Cache::TranspositionTable::resize(const size_t entries, const unsigned threads) {
+    wait();
+    // Free the old table first, so we don't hold both at once.
+    _data.reset();
+    // Limit our index to a power of two number of buckets.
+    max_index = std::bit_floor(std::max(entries / bucket_size, size_t(1)));
+    bitmask = max_index - 1;
+    TransBucket *ptr = static_cast<TransBucket *>(large_page_alloc(max_index * sizeof(TransBucket)));
+    _data = std::unique_ptr<TransBucket[], LargePageDeleter>(ptr);
+    // Constructing the buckets writes to every page, so the first search doesn't pay for the page faults.
+    clear(threads);
+}
+
+void Cache::TranspositionTable::clear(const unsigned threads) {
+    wait();
+    // Each thread (re)constructs its own slice of the buckets.
+    const unsigned n_workers = std::max(threads, 1u);
+    const size_t slice = (max_index + n_workers - 1) / n_workers;
+    TransBucket *ptr = _data.get();
+    for (unsigned t = 0; t < n_workers; t++) {
+        const size_t begin = std::min(t * slice, max_index);
+        const size_t end = std::min(begin + slice, max_index);
+        workers.emplace_back([ptr, begin, end]() {
+            for (size_t i = begin; i < end; i++) {
+                new (ptr + i) TransBucket();
+            }
+        });
+    }
+}
+
+bool Cache::TranspositionTable::save(const std::string &path) {
+    wait();
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    char header[snapshot_header_size] = {};
+    // Value initialised and filled in field by field, so the struct's padding is zeroed too and snapshots are the same
+    // byte for byte.
+    SnapshotHeader info{};
+    info.magic = snapshot_magic;
+    info.version = snapshot_version;
+    info.bucket_bytes = sizeof(TransBucket);
+    info.n_buckets = max_index;
+    info.generation = generation;
+    std::memcpy(header, &info, sizeof(info));
+    file.write(header, snapshot_header_size);
+    // Nothing is searching, so the buckets can be written out as they are.
+    file.write(reinterpret_cast<const char *>(_data.get()), max_index * sizeof(TransBucket));
+    return file.good();
+}
+
+bool Cache::TranspositionTable::load(const std::string &path) {
+    wait();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    SnapshotHeader info;
+    file.read(reinterpret_cast<char *>(&info), sizeof(info));
+    if (!file || info.magic != snapshot_magic || info.version != snapshot_version ||
+        info.bucket_bytes != sizeof(TransBucket) || !std::has_single_bit(info.n_buckets)) {
+        return false;
+    }
+    const size_t table_bytes = info.n_buckets * sizeof(TransBucket);
+    file.seekg(0, std::ios::end);
+    if (size_t(file.tellg()) != snapshot_header_size + table_bytes) {
+        return false;
+    }
+
+    std::unique_ptr<TransBucket[], LargePageDeleter> data;
+#if !defined(_WIN32)
+    // Map the file privately rather than reading it, pages are only read in as they are probed and stores never make
+    // it back to the file.
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        const size_t mapped_size = snapshot_header_size + table_bytes;
+        void *mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped != MAP_FAILED) {
+            TransBucket *ptr = reinterpret_cast<TransBucket *>(static_cast<char *>(mapped) + snapshot_header_size);
+            data = std::unique_ptr<TransBucket[], LargePageDeleter>(ptr, LargePageDeleter{mapped, mapped_size});
+        }
+    }
+#endif
+    if (!data) {
+        // Fall back to reading the whole file in.
+        data = std::unique_ptr<TransBucket[], LargePageDeleter>(
+            static_cast<TransBucket *>(large_page_alloc(table_bytes)));
+        file.seekg(snapshot_header_size);
+        file.read(reinterpret_cast<char *>(data.get()), table_bytes);
+        if (!file) {
+            return false;
+        }
+    }
+    _data = std::move(data);
+    max_index = info.n_buckets;
     bitmask = max_index - 1;
-    _data.resize(max_index);
+    generation = info.generation % generation_cycle;
+    return true;
+}
+
+void Cache::TranspositionTable::wait() {
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+Cache::TransElement::TransElement(zobrist_t h, uint64_t data)
+    : _hash(h), score(data & 0xffff), _static_eval((data >> 48) & 0xffff), _depth((data >> 32) & 0xff),
+      info((data >> 40) & 0xff) {
+    hash_move.v = (data >> 16) & 0xffff;
+}
+
+uint64_t Cache::TransElement::data() const {
+    return (uint64_t)(uint16_t)score | ((uint64_t)(uint16_t)hash_move.v << 16) | ((uint64_t)_depth << 32) |
+           ((uint64_t)(uint8_t)info << 40) | ((uint64_t)(uint16_t)_static_eval << 48);
 }
 
 bool Cache::TranspositionTable::probe(const zobrist_t hash, TransElement &hit) {
-    assert(_data.size() <= max_index);
     if (is_enabled() == false) {
         return false;
     }
-    const zobrist_t index = hash & bitmask;
-    hit = _data.at(index);
-    if (hit.hash() == hash) {
-        return true;
-    } else {
-        return false;
+    const TransBucket &bucket = _data[hash & bitmask];
+    for (const TransSlot &slot : bucket.slots) {
+        const TransElement elem = read(slot);
+        if (elem.hash() == hash) {
+            hit = elem;
+            return true;
+        }
     }
+    return false;
 }
 
 score_t Cache::eval_to_tt(const score_t eval, const ply_t ply) {
@@ -51,31 +235,52 @@ score_t Cache::eval_from_tt(const score_t eval, const ply_t ply) {
 }
 
 void Cache::TranspositionTable::store(const zobrist_t hash, const score_t eval, const Bounds bound, const depth_t depth,
-                                      const Move move, const ply_t ply) {
-    assert(_data.size() <= max_index);
-
+                                      const Move move, const ply_t ply, const score_t static_eval) {
     if (is_enabled() == false) {
         return;
     }
-    const TransElement elem = TransElement(hash, eval_to_tt(eval, ply), bound, depth, move);
-    const zobrist_t index = hash & bitmask;
-    const TransElement oldelem = _data.at(index);
-
-    if (oldelem.is_delete()) {
-        // Always replace if the old value is due to be replaced.
-        _data.at(index) = elem;
-    }
-    if (elem.hash() == oldelem.hash()) {
-        // If the entries refer to the same position, we want to only replace if the new entry is better, i.e. it's
-        // exact and wasn't or it's a higher depth.
-        if ((elem.exact() == oldelem.exact()) && (elem.depth() >= oldelem.depth())) {
-            _data.at(index) = elem;
-        } else if (elem.exact() && !oldelem.exact()) {
-            _data.at(index) = elem;
+    TransElement elem = TransElement(hash, eval_to_tt(eval, ply), bound, depth, move, static_eval);
+    elem.set_generation(generation);
+    TransBucket &bucket = _data[hash & bitmask];
+
+    TransSlot *replace = &bucket.slots[0];
+    int replace_value = INT32_MAX;
+    for (TransSlot &slot : bucket.slots) {
+        const TransElement oldelem = read(slot);
+        if (elem.hash() == oldelem.hash()) {
+            if (!elem.has_static_eval()) {
+                elem.set_static_eval(oldelem.static_eval());
+            }
+            // If the entries refer to the same position, we want to only replace if the new entry is better, i.e. it's
+            // exact and wasn't or it's a higher depth.
+            if ((oldelem.generation() != generation) || (elem.exact() && !oldelem.exact()) ||
+                ((elem.exact() == oldelem.exact()) && (elem.depth() >= oldelem.depth()))) {
+                write(slot, elem);
+            }
+            return;
+        }
+        // Otherwise overwrite the least valuable entry in the bucket, weighing depth against how many searches ago the
+        // entry was written.
+        const int age = (generation_cycle + generation - oldelem.generation()) % generation_cycle;
+        const int value = oldelem.depth() - 8 * age;
+        if (value < replace_value) {
+            replace = &slot;
+            replace_value = value;
         }
-    } else {
-        _data.at(index) = elem;
     }
+    write(*replace, elem);
+}
+
+Cache::TransElement Cache::TranspositionTable::read(const TransSlot &slot) {
+    // Relaxed is enough, the xor check catches an entry written by two different stores.
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    return TransElement(slot.key.load(std::memory_order_relaxed) ^ data, data);
+}
+
+void Cache::TranspositionTable::write(TransSlot &slot, const TransElement &elem) {
+    const uint64_t data = elem.data();
+    slot.key.store(elem.hash() ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
 }
 
 void Cache::TranspositionTable::prefetch(const zobrist_t hash) {
@@ -88,56 +293,51 @@ void Cache::TranspositionTable::prefetch(const zobrist_t hash) {
 #endif
 }
 
-void Cache::TranspositionTable::set_delete() {
-    for (TransElement t : _data) {
-        // Iterates through the entire data structure
-        t.set_delete();
-    }
+void Cache::init() {
+    history_table = HistoryTable();
+    countermove_table = CountermoveTable();
 }
 
-KillerTableRow Cache::KillerTable::probe(const ply_t ply) {
-    assert(ply < MAX_PLY);
-    if (is_enabled() == false) {
-        return NULL_KROW;
-    }
-    return _data[ply];
+void Cache::reinit(const unsigned threads) {
+    // Reallocate the transposition table at the new size, it is faulted in in the background.
+    transposition_table.resize(tt_max, threads);
 }
 
-void Cache::KillerTable::store(const ply_t ply, const Move move) {
-    assert(ply < MAX_PLY);
-    if (is_enabled() == false) {
-        return;
-    }
-    // Put this check here rather than in the search for simplicity
-    if (move == NULL_MOVE) {
-        return;
-    }
-    // Store the move, only if it's a quiet move.
-    if (move.type != QUIETmv) {
-        return;
+void Cache::clear(const unsigned threads) {
+    // Zero the transposition table in the background.
+    transposition_table.clear(threads);
+}
+
+bool Cache::save(const std::string &path) { return transposition_table.save(path); }
+
+bool Cache::load(const std::string &path) {
+    if (!transposition_table.load(path)) {
+        return false;
     }
-    // Don't keep duplicates
-    if (move == _data[ply]) {
-        return;
+    // The snapshot decides the size of the table.
+    tt_max = transposition_table.size();
+    return true;
+}
+
+bool Cache::EvalCache::probe(const zobrist_t hash, score_t &eval) {
+    _probes++;
+    const uint64_t entry = _data[hash & (eval_cache_size - 1)];
+    if (((entry ^ hash) & key_mask) != 0) {
+        return false;
     }
-    const DenseMove dmove = pack_move(move);
-    int index = indicies[ply];
-    _data[ply][index] = dmove;
-    // Increment the counter so we use all the slots
-    indicies[ply]++;
-    indicies[ply] %= n_krow;
+    _hits++;
+    eval = static_cast<int16_t>(entry & ~key_mask);
+    return true;
 }
 
-void Cache::init() {
-    killer_table = KillerTable();
-    transposition_table = TranspositionTable();
-    history_table = HistoryTable();
-    countermove_table = CountermoveTable();
+void Cache::EvalCache::store(const zobrist_t hash, const score_t eval) {
+    _data[hash & (eval_cache_size - 1)] = (hash & key_mask) | static_cast<uint16_t>(eval);
 }
 
-void Cache::reinit() {
-    // Create a new transposition table, of the new size.
-    transposition_table = TranspositionTable();
+void Cache::EvalCache::clear() {
+    std::fill(_data.begin(), _data.end(), 0);
+    _probes = 0;
+    _hits = 0;
 }
 
 uint Cache::HistoryTable::probe(const Move move) {
@@ -1,94 +1,160 @@
 #include "types.hpp"
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace Cache {
 enum TransState {
-    EXACT = 0,   // Stored score is exact for the node
-    LOWER = 1,   // Stored score is a lower bound
-    UPPER = 2,   // Stored score is an upper bound
-    DELETE = 4,  // Entry has been marked for deletion
-    CACHEHIT = 8 // Entry has had cache hit before
+    EXACT = 0, // Stored score is exact for the node
+    LOWER = 1, // Stored score is a lower bound
+    UPPER = 2  // Stored score is an upper bound
 };
-typedef int8_t tt_flags_t;
+typedef uint8_t tt_flags_t;
 constexpr tt_flags_t bound_mask = 0x03;
+// The rest of the flags hold the generation (i.e. the search) the entry was written in, wrapping around.
+constexpr unsigned generation_shift = 2;
+constexpr uint8_t generation_cycle = 1 << (8 - generation_shift);
+
+// Stored as the static eval of entries written without one, e.g. from a tablebase probe. Never a real eval, those are
+// clamped short of the mate scores.
+constexpr score_t no_static_eval = MIN_SCORE;
 
 score_t eval_to_tt(const score_t eval, const ply_t ply);
 score_t eval_from_tt(const score_t eval, const ply_t ply);
-// 16 (14) bytes
+// A decoded copy of a table entry. The search only ever sees these, the table itself holds packed words.
 struct TransElement {
     TransElement() = default;
-    TransElement(zobrist_t h, score_t eval, Bounds bound, depth_t d, Move m)
-        : _hash(h), score(eval), _depth(d),
+    TransElement(zobrist_t h, score_t eval, Bounds bound, depth_t d, Move m, score_t static_eval = no_static_eval)
+        : _hash(h), score(eval), _static_eval(static_eval), _depth(d),
           info((bound == Bounds::UPPER) ? TransState::UPPER
                                         : (bound == Bounds::LOWER) ? TransState::LOWER : TransState::EXACT),
           hash_move(pack_move(m)){};
+    TransElement(zobrist_t h, uint64_t data);
     score_t eval(ply_t ply) const { return eval_from_tt(score, ply); }
+    // The static eval of the position, so a node that can't use the score can still skip the network.
+    score_t static_eval() const { return _static_eval; }
+    bool has_static_eval() const { return _static_eval != no_static_eval; }
+    void set_static_eval(const score_t static_eval) { _static_eval = static_eval; }
     bool lower() const { return (info & bound_mask) == TransState::LOWER; }
     bool upper() const { return (info & bound_mask) == TransState::UPPER; }
     bool exact() const { return (info & bound_mask) == TransState::EXACT; }
-    bool is_delete() const { return (info & TransState::DELETE) == TransState::DELETE; }
-    bool is_cache_hit() const { return (info & TransState::CACHEHIT) == TransState::CACHEHIT; }
-    void set_delete() { info |= TransState::DELETE; }
-    void set_cache_hit() { info |= TransState::CACHEHIT; }
+    uint8_t generation() const { return info >> generation_shift; }
+    void set_generation(const uint8_t gen) { info = (info & bound_mask) | (gen << generation_shift); }
     tt_flags_t flags() { return info; }
     depth_t depth() const { return _depth; }
     DenseMove move() const { return hash_move; }
     zobrist_t hash() const { return _hash; }
+    // Everything but the hash, packed into a single word.
+    uint64_t data() const;
 
   private:
     zobrist_t _hash;
     int16_t score = 0;
+    int16_t _static_eval = no_static_eval;
     uint8_t _depth = 0;
     tt_flags_t info = EXACT;
     DenseMove hash_move = NULL_DMOVE;
 };
 
+// 16 bytes
+// The entry as it sits in the table, shared between threads. The key is stored xor'd with the data, so a probe can
+// only match the hash if both words were written by the same store. A torn entry just looks like a miss.
+struct TransSlot {
+    std::atomic<uint64_t> key = 0;
+    std::atomic<uint64_t> data = 0;
+};
+
+// Entries are grouped in buckets of one cache line, so a probe touches a single line and a store has a few entries to
+// choose from when picking what to overwrite.
+constexpr size_t bucket_size = 4;
+struct alignas(64) TransBucket {
+    TransSlot slots[bucket_size];
+};
+static_assert(sizeof(TransBucket) == 64);
+
 constexpr unsigned hash_default = 64u;
 constexpr unsigned hash_min = 1u;
 constexpr unsigned hash_max = 8192u;
 
-inline size_t tt_max = (hash_default * (1 << 20)) / sizeof(TransElement);
+inline size_t tt_max = (hash_default * (1 << 20)) / sizeof(TransSlot);
+
+// The table is allocated aligned to (and, where the OS allows, backed by) 2 MiB pages to cut down on TLB misses.
+// A table loaded from a snapshot may instead be a private mapping of the file, in which case the deleter unmaps it.
+struct LargePageDeleter {
+    void operator()(TransBucket *ptr) const;
+    void *mapped = nullptr;
+    size_t mapped_size = 0;
+};
+
+// Snapshots are a header padded to a page, followed by the raw buckets. The version is bumped whenever the entry
+// layout changes.
+constexpr uint64_t snapshot_magic = 0x544e54454d444140; // "@ADMETNT"
+constexpr uint32_t snapshot_version = 2;
+constexpr size_t snapshot_header_size = 4096;
 
 class TranspositionTable {
   public:
     TranspositionTable();
+    ~TranspositionTable() { wait(); }
+    // Reallocate for a new number of entries. The new table is zeroed (and so faulted in) on background threads, call
+    // wait() before using it.
+    void resize(const size_t entries, const unsigned threads = 1);
+    void wait();
     bool probe(const zobrist_t, TransElement &hit);
     void store(const zobrist_t hash, const score_t eval, const Bounds bound, const depth_t depth, const Move move,
-               const ply_t ply);
+               const ply_t ply, const score_t static_eval = no_static_eval);
     void prefetch(const zobrist_t hash);
-    void clear() { _data.clear(); }
+    // Zero the table on background threads, call wait() before using it.
+    void clear(const unsigned threads = 1);
     bool is_enabled() { return enabled; }
     void enable() { enabled = true; }
     void disable() { enabled = false; }
-    void set_delete();
+    // Start a new search, entries from older searches become preferred for replacement.
+    void new_search() { generation = (generation + 1) % generation_cycle; }
+    // Write the table to a snapshot file, or replace it (and its size) with one. Both return false on failure, a
+    // failed load leaves the table as it was.
+    bool save(const std::string &path);
+    bool load(const std::string &path);
+    size_t size() const { return max_index * bucket_size; }
 
   private:
-    std::vector<TransElement> _data;
+    static TransElement read(const TransSlot &slot);
+    static void write(TransSlot &slot, const TransElement &elem);
+    std::unique_ptr<TransBucket[], LargePageDeleter> _data;
+    std::vector<std::thread> workers;
     size_t max_index;
     zobrist_t bitmask;
+    uint8_t generation = 0;
     bool enabled = true;
 };
 
+// The transposition table is shared between all search threads.
 inline TranspositionTable transposition_table;
 
-class KillerTable {
-    // Table for the killer heuristic;
+// Static evaluations of recently evaluated positions, so a position reached again (in a sibling line, or from
+// quiescence) skips the network. Each search thread has its own, so entries are plain words: the top 48 bits of the
+// hash as the key, and the eval in the low 16 bits.
+constexpr size_t eval_cache_size = 1 << 16;
+class EvalCache {
   public:
-    KillerTable() = default;
-    KillerTableRow probe(const ply_t ply);
-    void store(const ply_t ply, const Move move);
-    bool is_enabled() { return enabled; }
-    void enable() { enabled = true; }
-    void disable() { enabled = false; }
+    EvalCache() : _data(eval_cache_size, 0) {}
+    bool probe(const zobrist_t hash, score_t &eval);
+    void store(const zobrist_t hash, const score_t eval);
+    void clear();
+    uint64_t probes() const { return _probes; }
+    uint64_t hits() const { return _hits; }
 
   private:
-    std::array<KillerTableRow, MAX_PLY> _data;
-    std::array<int, MAX_PLY> indicies;
-    bool enabled = true;
+    static constexpr zobrist_t key_mask = ~zobrist_t(0xFFFF);
+    std::vector<uint64_t> _data;
+    uint64_t _probes = 0;
+    uint64_t _hits = 0;
 };
-
-inline KillerTable killer_table;
+inline thread_local EvalCache eval_cache;
 
 class HistoryTable {
     // Table for the history heuristic;
@@ -106,7 +172,8 @@ class HistoryTable {
     uint _data[N_PIECE][N_SQUARE];
     bool enabled = true;
 };
-inline HistoryTable history_table;
+// Each search thread keeps its own history.
+inline thread_local HistoryTable history_table;
 
 class CountermoveTable {
     // Table for the history heuristic;
@@ -126,5 +193,8 @@ class CountermoveTable {
 };
 inline CountermoveTable countermove_table;
 void init();
-void reinit();
+void reinit(const unsigned threads = 1);
+void clear(const unsigned threads = 1);
+bool save(const std::string &path);
+bool load(const std::string &path);
 } // namespace Cache
\ No newline at end of file
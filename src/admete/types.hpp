@@ -1,6 +1,8 @@
 #pragma once
+#include <algorithm>
 #include <array>
 #include <assert.h>
+#include <initializer_list>
 #include <inttypes.h>
 #include <string>
 #include <vector>
@@ -425,9 +427,61 @@ inline bool operator==(const Move m, const KillerTableRow row) {
     return false;
 }
 
-typedef std::vector<Move> MoveList;
+// A list of moves with room for any position, kept inline so that generating moves never touches the heap. Only the
+// moves in use are copied, and the storage is left uninitialised until a move is pushed.
+class MoveList {
+  public:
+    MoveList() {}
+    MoveList(std::initializer_list<Move> moves) {
+        for (const Move move : moves) {
+            push_back(move);
+        }
+    }
+    MoveList(const MoveList &other) : _size(other._size) { std::copy(other.begin(), other.end(), begin()); }
+    MoveList &operator=(const MoveList &other) {
+        _size = other._size;
+        std::copy(other.begin(), other.end(), begin());
+        return *this;
+    }
+
+    void push_back(const Move move) {
+        assert(_size < MAX_MOVES);
+        data[_size++] = move;
+    }
+    void pop_back() {
+        assert(_size > 0);
+        _size--;
+    }
+    void clear() { _size = 0; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    Move &operator[](const size_t i) {
+        assert(i < _size);
+        return data[i];
+    }
+    const Move &operator[](const size_t i) const {
+        assert(i < _size);
+        return data[i];
+    }
+    Move &front() { return (*this)[0]; }
+    const Move &front() const { return (*this)[0]; }
+    Move &back() { return (*this)[_size - 1]; }
+    const Move &back() const { return (*this)[_size - 1]; }
+
+    Move *begin() { return data; }
+    Move *end() { return data + _size; }
+    const Move *begin() const { return data; }
+    const Move *end() const { return data + _size; }
+
+  private:
+    size_t _size = 0;
+    union {
+        Move data[MAX_MOVES];
+    };
+};
 
-inline bool operator==(const DenseMove dm, const MoveList moves) {
+inline bool operator==(const DenseMove dm, const MoveList &moves) {
     for (Move m : moves) {
         if (m == dm) {
             return true;
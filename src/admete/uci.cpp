@@ -11,6 +11,7 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include "netfile.hpp"
 #include "ordering.hpp"
 #include "weights.hpp"
 
@@ -108,7 +109,11 @@ void init_uci() {
     std::cout << "id author " << ENGINE_AUTH << std::endl;
     std::cout << "option name Hash type spin default " << Cache::hash_default << " min " << Cache::hash_min << " max "
               << Cache::hash_max << std::endl;
+    std::cout << "option name Threads type spin default " << Search::threads_default << " min " << Search::threads_min
+              << " max " << Search::threads_max << std::endl;
+    std::cout << "option name Clear Hash type button" << std::endl;
     std::cout << "option name SyzygyPath type string default <empty>" << std::endl;
+    std::cout << "option name EvalFile type string default <empty>" << std::endl;
 
     for (const auto &option : uci_options) {
         std::cout << option->print() << std::endl;
@@ -117,7 +122,14 @@ void init_uci() {
     std::cout << "uciok" << std::endl;
 }
 
-void set_option(std::istringstream &is, Search::SearchOptions &options) {
+std::string read_path(std::istringstream &is) {
+    // The rest of the line, so paths can contain spaces.
+    std::string path;
+    std::getline(is >> std::ws, path);
+    return path;
+}
+
+void set_option(Board &board, std::istringstream &is, Search::SearchOptions &options) {
     /*
      * setoption name  [value ]
      *        this is sent to the engine when the user wants to change the internal parameters
@@ -146,6 +158,11 @@ void set_option(std::istringstream &is, Search::SearchOptions &options) {
     } else {
         return;
     }
+    if (option == "Clear Hash") {
+        // Button, so takes no value.
+        Cache::clear(Search::n_threads);
+        return;
+    }
     if (token != "value") {
         return;
     }
@@ -159,10 +176,23 @@ void set_option(std::istringstream &is, Search::SearchOptions &options) {
             std::cerr << "Hash min = " << Cache::hash_min << " MiB" << std::endl;
         }
         value = std::clamp(value, Cache::hash_min, Cache::hash_max);
-        Cache::tt_max = (value * (1 << 20)) / sizeof(Cache::TransElement);
-        Cache::reinit();
+        Cache::tt_max = (size_t(value) * (1 << 20)) / sizeof(Cache::TransSlot);
+        Cache::reinit(Search::n_threads);
         return;
     } 
+
+    if (option == "Threads") {
+        unsigned value = 1;
+        is >> std::ws >> value;
+
+        if (value > Search::threads_max) {
+            std::cerr << "Threads max = " << Search::threads_max << std::endl;
+        } else if (value < Search::threads_min) {
+            std::cerr << "Threads min = " << Search::threads_min << std::endl;
+        }
+        Search::n_threads = std::clamp(value, Search::threads_min, Search::threads_max);
+        return;
+    }
     
     if (option == "SyzygyPath") {
         // Set the path to a file of input paramters
@@ -185,6 +215,26 @@ void set_option(std::istringstream &is, Search::SearchOptions &options) {
         return;
     }
 
+    if (option == "EvalFile") {
+        // A network file, or <empty> for the compiled in network.
+        const std::string path = read_path(is);
+        if (path.empty() || path == "<empty>") {
+            Neural::reset_network();
+        } else if (Neural::load_network(path)) {
+            std::cerr << "Load network from " << path << " successful." << std::endl;
+        } else {
+            std::cerr << "Load network from " << path << " unsuccessful." << std::endl;
+            return;
+        }
+        // Static evals in the hash table are from the old network. The eval cache is thread_local and the search
+        // threads start with empty ones for each search, so this only clears this thread's, which `h` uses.
+        Cache::eval_cache.clear();
+        Cache::clear(Search::n_threads);
+        // The board's accumulator still holds the old network's weights.
+        board.reload_network();
+        return;
+    }
+
     std::string value;
     while (is >> token) {
         if (value.empty()) {
@@ -263,13 +313,12 @@ void bestmove(Board &board, const Move move) {
 void do_search(Board *board, depth_t max_depth, const int soft_cutoff, const int hard_cutoff,
                Search::SearchOptions *options) {
     PrincipleLine line;
-    line.reserve(max_depth);
     options->stop_flag.store(false);
     options->running_flag.store(true);
     options->nodes = 0;
     int score = Search::search(*board, max_depth, soft_cutoff, hard_cutoff, line, *options);
     options->eval = score;
-    Move first_move = line.back();
+    Move first_move = line.empty() ? NULL_MOVE : line.front();
     bestmove(*board, first_move);
     // Set this so that the thread can be joined.
     options->running_flag.store(false);
@@ -439,7 +488,7 @@ void stop(Search::SearchOptions &options) {
 }
 
 void uci_info(depth_t depth, score_t eval, unsigned long nodes, unsigned long tbhits, unsigned long nps,
-              PrincipleLine principle, unsigned int time, ply_t root_ply) {
+              const PrincipleLine &principle, unsigned int time, ply_t root_ply) {
     if (!uci_enabled) {
         return;
     }
@@ -468,8 +517,8 @@ void uci_info(depth_t depth, score_t eval, unsigned long nodes, unsigned long tb
         std::cout << " nps " << nps;
     }
     std::cout << " pv ";
-    for (PrincipleLine::reverse_iterator it = principle.rbegin(); it != principle.rend(); ++it) {
-        std::cout << it->pretty() << " ";
+    for (const Move move : principle) {
+        std::cout << move.pretty() << " ";
     }
     std::cout << " time " << time;
     std::cout << std::endl;
@@ -539,6 +588,47 @@ void quiesce(Board &board) {
     board.unpack(pos);
 }
 
+void save_hash(std::istringstream &is) {
+    // Write the transposition table to a snapshot, to carry analysis over between sessions.
+    const std::string path = read_path(is);
+    if (Cache::save(path)) {
+        std::cerr << "Save hash to " << path << " successful." << std::endl;
+    } else {
+        std::cerr << "Save hash to " << path << " unsuccessful." << std::endl;
+    }
+}
+
+void save_net(std::istringstream &is) {
+    // Write the compiled in network to a file, which can then be loaded with EvalFile.
+    const std::string path = read_path(is);
+    if (Neural::save_network(path)) {
+        std::cerr << "Save network to " << path << " successful." << std::endl;
+    } else {
+        std::cerr << "Save network to " << path << " unsuccessful." << std::endl;
+    }
+}
+
+void load_hash(std::istringstream &is) {
+    // Replace the transposition table with a snapshot, resizing it to match.
+    const std::string path = read_path(is);
+    if (Cache::load(path)) {
+        std::cerr << "Load hash from " << path << " successful." << std::endl;
+    } else {
+        std::cerr << "Load hash from " << path << " unsuccessful." << std::endl;
+    }
+}
+
+void eval_stats(const Search::SearchOptions &options) {
+    // Eval cache lookups and hits over the last search, summed over its threads, for sizing the cache.
+    if (options.is_running()) {
+        std::cout << "info string eval cache stats are ready once the search has finished" << std::endl;
+        return;
+    }
+    const uint64_t hitrate = options.evalprobes > 0 ? (100 * options.evalhits) / options.evalprobes : 0;
+    std::cout << "info string evalcache probes " << options.evalprobes << " hits " << options.evalhits << " hitrate "
+              << hitrate << "%" << std::endl;
+}
+
 void uci() {
     uci_enabled = true;
     std::string command, token;
@@ -553,14 +643,17 @@ void uci() {
         if (token == "uci") {
             init_uci();
         } else if (token == "isready") {
-            // Interface is asking if we can continue, if we are here, we clearly can.
+            // Interface is asking if we can continue, once any search has stopped and the hash table is ready.
             stop(options);
+            Cache::transposition_table.wait();
             std::cout << "readyok" << std::endl;
         } else if (token == "ucinewgame") {
+            stop(options);
             board.initialise_starting_position();
+            Cache::clear(Search::n_threads);
         } else if (token == "setoption") {
             stop(options);
-            set_option(is, options);
+            set_option(board, is, options);
         } else if (token == "position") {
             stop(options);
             position(board, is);
@@ -587,6 +680,16 @@ void uci() {
             std::cout << std::dec << (int)v << std::endl;
         } else if (token == "features") {
             print_features(board, is);
+        } else if (token == "savehash") {
+            stop(options);
+            save_hash(is);
+        } else if (token == "loadhash") {
+            stop(options);
+            load_hash(is);
+        } else if (token == "savenet") {
+            save_net(is);
+        } else if (token == "evalstats") {
+            eval_stats(options);
         }
         else {
             std::cerr << "Unknown command: " << token << std::endl;
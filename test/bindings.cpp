@@ -0,0 +1,140 @@
+#include "api.h"
+#include "board.hpp"
+#include "evaluate.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string test_fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "2rq1rk1/pp1bppbp/2np1np1/8/3NP3/1BN1BP2/PPPQ2PP/2KR3R b - - 8 11",
+    "rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 3",
+};
+constexpr size_t n_test_fens = sizeof(test_fens) / sizeof(test_fens[0]);
+const std::string bad_fen = "8/8/8/8/8/8/8/8 x - - 0 1";
+
+// Enough positions that the batch is split between several workers.
+std::vector<std::string> batch_fens(const size_t n) {
+  std::vector<std::string> fens;
+  for (size_t i = 0; i < n; i++) {
+    fens.push_back(test_fens[i % n_test_fens]);
+  }
+  return fens;
+}
+} // namespace
+
+TEST(Bindings, EvaluateBatch) {
+  const std::vector<std::string> fens = batch_fens(1000);
+  std::vector<const char *> ptrs;
+  for (const std::string &fen : fens) {
+    ptrs.push_back(fen.c_str());
+  }
+  std::vector<float> out(fens.size());
+  ASSERT_EQ(evaluate_batch(ptrs.data(), ptrs.size(), out.data(), 4), 0);
+
+  Board board;
+  for (size_t i = 0; i < fens.size(); i++) {
+    board.fen_decode(fens[i]);
+    EXPECT_FLOAT_EQ(out[i], Evaluation::network_eval(board) * Neural::LOGISTIC_SCALING) << fens[i];
+  }
+}
+
+TEST(Bindings, EvaluateBatchErrors) {
+  const char *fens[] = {test_fens[0].c_str(), bad_fen.c_str(), nullptr, test_fens[1].c_str()};
+  float out[4];
+  EXPECT_EQ(evaluate_batch(fens, 4, out, 2), 3);
+  EXPECT_FALSE(std::isnan(out[0]));
+  EXPECT_TRUE(std::isnan(out[1]));
+  EXPECT_TRUE(std::isnan(out[2]));
+  EXPECT_FALSE(std::isnan(out[3]));
+
+  EXPECT_EQ(evaluate_batch(fens, -1, out, 1), 1);
+  EXPECT_EQ(evaluate_batch(nullptr, 4, out, 1), 2);
+  EXPECT_EQ(evaluate_batch(fens, 0, out, 1), 0);
+}
+
+namespace {
+// Pack the fens into one buffer, as encode_features_batch takes them, after `lead` bytes of junk and with `pad(i)`
+// spaces after fen i.
+template <typename F>
+std::string pack_fens(const std::vector<std::string> &fens, std::vector<int64_t> &offsets, const size_t lead, F pad) {
+  std::string packed(lead, 'x');
+  offsets.clear();
+  for (size_t i = 0; i < fens.size(); i++) {
+    offsets.push_back(packed.size());
+    packed += fens[i] + std::string(pad(i), ' ');
+  }
+  offsets.push_back(packed.size());
+  return packed;
+}
+
+// Check fen i of the batch was encoded as encode_features encodes it on its own.
+void expect_matches_single(const std::string &fen, const size_t i, const std::vector<char> &features,
+                           const std::vector<char> &white_to_play, const int quiesce) {
+  std::string copy = fen;
+  char expected[N_SQUARE];
+  char expected_white = 0;
+  ASSERT_EQ(encode_features(copy.data(), expected, N_SQUARE, &expected_white, quiesce), 0);
+  EXPECT_EQ(white_to_play[i], expected_white) << fen;
+  EXPECT_TRUE(std::equal(expected, expected + N_SQUARE, features.begin() + i * N_SQUARE)) << fen;
+}
+} // namespace
+
+TEST(Bindings, EncodeFeaturesBatch) {
+  const std::vector<std::string> fens = batch_fens(600);
+  std::vector<int64_t> offsets;
+  const std::string packed = pack_fens(fens, offsets, 0, [](size_t) { return 0; });
+  for (const int quiesce : {0, 1}) {
+    std::vector<char> features(N_SQUARE * fens.size(), 0x55);
+    std::vector<char> white_to_play(fens.size(), 0x55);
+    ASSERT_EQ(encode_features_batch(packed.data(), offsets.data(), fens.size(), features.data(), white_to_play.data(),
+                                    quiesce, 4),
+              0);
+    for (size_t i = 0; i < fens.size(); i++) {
+      expect_matches_single(fens[i], i, features, white_to_play, quiesce);
+    }
+  }
+}
+
+TEST(Bindings, EncodeFeaturesBatchOffsets) {
+  // The fens don't start at the beginning of the buffer, and have different amounts of padding between them.
+  const std::vector<std::string> fens = batch_fens(300);
+  std::vector<int64_t> offsets;
+  const std::string packed = pack_fens(fens, offsets, 7, [](size_t i) { return i % 5; });
+  std::vector<char> features(N_SQUARE * fens.size(), 0x55);
+  std::vector<char> white_to_play(fens.size(), 0x55);
+  ASSERT_EQ(encode_features_batch(packed.data(), offsets.data(), fens.size(), features.data(), white_to_play.data(), 0,
+                                  3),
+            0);
+  for (size_t i = 0; i < fens.size(); i++) {
+    expect_matches_single(fens[i], i, features, white_to_play, 0);
+  }
+}
+
+TEST(Bindings, EncodeFeaturesBatchErrors) {
+  const std::vector<std::string> fens = {test_fens[0], bad_fen, test_fens[6]};
+  std::vector<int64_t> offsets;
+  const std::string packed = pack_fens(fens, offsets, 0, [](size_t) { return 0; });
+  std::vector<char> features(N_SQUARE * fens.size(), 0x55);
+  std::vector<char> white_to_play(fens.size(), 0x55);
+  EXPECT_EQ(encode_features_batch(packed.data(), offsets.data(), fens.size(), features.data(), white_to_play.data(), 0,
+                                  2),
+            3);
+  EXPECT_EQ(white_to_play[1], -1);
+  EXPECT_TRUE(std::all_of(features.begin() + N_SQUARE, features.begin() + 2 * N_SQUARE, [](char c) { return c == 0; }));
+  // The bad fen doesn't stop the others being encoded.
+  expect_matches_single(fens[0], 0, features, white_to_play, 0);
+  expect_matches_single(fens[2], 2, features, white_to_play, 0);
+
+  EXPECT_EQ(encode_features_batch(packed.data(), offsets.data(), -1, features.data(), white_to_play.data(), 0, 1), 1);
+  EXPECT_EQ(encode_features_batch(nullptr, offsets.data(), 3, features.data(), white_to_play.data(), 0, 1), 2);
+  EXPECT_EQ(encode_features_batch(packed.data(), offsets.data(), 0, features.data(), white_to_play.data(), 0, 1), 0);
+}
@@ -155,4 +155,84 @@ TEST(Board, GivesCheck) {
     EXPECT_NE(move, NULL_MOVE);
     EXPECT_FALSE(board.gives_check(move));
   }
-}
\ No newline at end of file
+}
+TEST(Board, LazyInfo) {
+  // The pins, check squares and attacks are filled in on demand. After any move (and after unmaking it, with or without
+  // having looked at them first) they should match a board set up from scratch.
+  std::string fens[] = {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+                        "rnbqkb1r/pppp1ppp/5n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 2 4"};
+  auto expect_fresh = [](const Board &board) {
+    Board fresh = Board();
+    fresh.fen_decode(board.fen_encode());
+    EXPECT_EQ(board.pinned(), fresh.pinned());
+    EXPECT_EQ(board.blockers(), fresh.blockers());
+    EXPECT_EQ(board.attacked(), fresh.attacked());
+    for (PieceType p = PAWN; p < N_PIECE; p++) {
+      EXPECT_EQ(board.check_squares(p), fresh.check_squares(p));
+    }
+  };
+  Board board = Board();
+  for (const std::string &fen : fens) {
+    board.fen_decode(fen);
+    MoveList moves;
+    board.get_moves(moves);
+    for (Move move : moves) {
+      board.make_move(move);
+      expect_fresh(board);
+      board.unmake_move(move);
+      expect_fresh(board);
+    }
+    for (Move move : moves) {
+      // Unmake without having used the child's info.
+      board.make_move(move);
+      board.unmake_move(move);
+    }
+    expect_fresh(board);
+  }
+}
+
+TEST(Board, Copy) {
+  // A copy is independent of the original, with its own history and accumulator.
+  Board board = Board();
+  board.fen_decode("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  MoveList moves;
+  board.get_moves(moves);
+  board.make_move(moves[0]);
+  const std::string fen = board.fen_encode();
+  const Board copy(board);
+  EXPECT_EQ(copy.fen_encode(), fen);
+  EXPECT_EQ(copy.hash(), board.hash());
+  EXPECT_EQ(copy.last_move(), moves[0]);
+  for (Colour c : {WHITE, BLACK}) {
+    EXPECT_EQ(copy.accumulator().get(c), board.accumulator().get(c));
+  }
+  board.unmake_move(moves[0]);
+  EXPECT_EQ(copy.fen_encode(), fen);
+  EXPECT_EQ(copy.last_move(), moves[0]);
+}
+
+TEST(Board, ByteEncoded) {
+  // Always encoded from the side to move's point of view, so black to move encodes as the flipped board would.
+  const std::vector<std::string> fens = {
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq - 0 1",
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 0 1",
+  };
+  Board board = Board();
+  board.fen_decode(fens[0]);
+  const auto start = board.byte_encoded();
+  EXPECT_EQ(start[0], ROOK + 1);
+  EXPECT_EQ(start[4], KING + 1);
+  EXPECT_EQ(start[60], KING + 9);
+  EXPECT_EQ(start[35], 0);
+  for (const std::string &fen : fens) {
+    board.fen_decode(fen);
+    const auto encoded = board.byte_encoded();
+    board.flip();
+    EXPECT_EQ(encoded, board.byte_encoded()) << fen;
+    uint8_t direct[N_SQUARE];
+    board.byte_encode(direct);
+    EXPECT_TRUE(std::equal(encoded.begin(), encoded.end(), direct)) << fen;
+  }
+}
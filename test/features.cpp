@@ -61,9 +61,12 @@ protected:
         // Verify we're back to initial position
         auto final_features = Neural::encode(board);
         for (Colour c : {WHITE, BLACK}) {
+            auto diff = reverse_diff[c].as_dense();
             for (size_t i = 0; i < Neural::N_FEATURES; i++) {
                 EXPECT_EQ(initial_features[c][i], final_features[c][i])
                     << "Position not properly restored at index " << i;
+                EXPECT_EQ(final_features[c][i], new_features[c][i] + diff[i])
+                    << "Reverse diff mismatch at index " << i;
             }
         }
     }
@@ -2,6 +2,9 @@
 #include "network.hpp"
 #include "weights.hpp"
 #include "board.hpp"
+#include "simd.hpp"
+#include <array>
+#include <random>
 
 using namespace Neural;
 
@@ -96,7 +99,7 @@ TEST_F(FixedAccumulatorTest, PreservesStateAfterMoveUnmove) {
             // Make and unmake the move, tracking accumulator state
             board.make_move(move);
             fixed_accumulator->make_move(move, ~board.who_to_play());
-            fixed_accumulator->unmake_move(move, ~board.who_to_play());
+            fixed_accumulator->unmake_move();
             board.unmake_move(move);
             
             // Verify state is preserved after move+unmove
@@ -209,7 +212,7 @@ TEST_F(FixedAccumulatorTest, NetworkEvaluationConsistency) {
             
             // Unmake move
             board.unmake_move(move);
-            fixed_accumulator->unmake_move(move, board.who_to_play());
+            fixed_accumulator->unmake_move();
             auto restored_eval = network.forward(*fixed_accumulator, board.who_to_play());
             
             // Check that evaluation is restored after unmake
@@ -220,4 +223,187 @@ TEST_F(FixedAccumulatorTest, NetworkEvaluationConsistency) {
                 << "Restored eval: " << restored_eval;
         }
     }
-}
\ No newline at end of file
+}
+TEST(SimdKernels, MatchScalar) {
+    // A length with a tail that does not fill a register, and values that wrap.
+    constexpr size_t n = 256 + 5;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(INT16_MIN, INT16_MAX);
+    std::array<int16_t, n> acc, row;
+    for (size_t i = 0; i < n; i++) {
+        acc[i] = dist(rng);
+        row[i] = dist(rng);
+    }
+    acc[0] = INT16_MAX;
+    row[0] = 1;
+
+    auto check = [&](auto add, auto sub) {
+        auto expected = acc, actual = acc;
+        simd::scalar::add(expected.data(), row.data(), n);
+        add(actual.data(), row.data(), n);
+        EXPECT_EQ(expected, actual);
+        simd::scalar::sub(expected.data(), row.data(), n);
+        sub(actual.data(), row.data(), n);
+        EXPECT_EQ(expected, actual);
+        EXPECT_EQ(acc, actual);
+    };
+    check(simd::add, simd::sub);
+#if defined(__SSE4_1__)
+    check(simd::sse::add, simd::sse::sub);
+#endif
+#if defined(__AVX2__)
+    check(simd::avx2::add, simd::avx2::sub);
+#endif
+}
+
+TEST(SimdKernels, DotMatchesScalar) {
+    // Activations are at most 127, with the extremes where the int16 pair sums are largest.
+    constexpr size_t n = 256 + 5;
+    std::mt19937 rng(42);
+    std::array<uint8_t, n> a;
+    std::array<int8_t, n> w;
+    for (size_t i = 0; i < n; i++) {
+        a[i] = rng() % 128;
+        w[i] = static_cast<int8_t>(rng() % 256 - 128);
+    }
+    a[0] = a[1] = 127;
+    w[0] = w[1] = -128;
+
+    const int32_t expected = simd::scalar::dot(a.data(), w.data(), n);
+    EXPECT_EQ(expected, simd::dot(a.data(), w.data(), n));
+#if defined(__SSE4_1__)
+    EXPECT_EQ(expected, simd::sse::dot(a.data(), w.data(), n));
+#endif
+#if defined(__AVX2__)
+    EXPECT_EQ(expected, simd::avx2::dot(a.data(), w.data(), n));
+#endif
+}
+
+TEST_F(FixedAccumulatorTest, KingBucketsShareUnbucketedWeights) {
+    // Unbucketed weights are used for every bucket, which gives exactly the unbucketed accumulator.
+    Accumulator<N_FEATURES, N_ACCUMULATED, ACC_SHIFT, N_KING_BUCKETS> bucketed(*floating_layer);
+    for (const auto& fen : test_positions) {
+        board.fen_decode(fen);
+        fixed_accumulator->initialise(board);
+        bucketed.initialise(board);
+        for (Colour c : {WHITE, BLACK}) {
+            EXPECT_EQ(fixed_accumulator->get(c), bucketed.get(c)) << "Position: " << fen;
+        }
+    }
+}
+
+TEST_F(FixedAccumulatorTest, KingBucketsIncremental) {
+    // Different weights for each bucket, so that using the wrong one shows.
+    using BucketedAcc = Accumulator<N_FEATURES, N_ACCUMULATED, ACC_SHIFT, N_KING_BUCKETS>;
+    constexpr size_t In = 2 * BucketedAcc::InputSize;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<nn_t> dist(-0.05, 0.05);
+    std::vector<nn_t> weights(In * N_ACCUMULATED), bias(N_ACCUMULATED);
+    for (auto& w : weights) w = dist(rng);
+    for (auto& b : bias) b = dist(rng);
+    BucketedAcc accumulator(std::make_unique<FloatingAccumulatorLayer<nn_t, BucketedAcc::InputSize, N_ACCUMULATED>>(
+        weights.data(), bias.data()));
+    // Never used, so its refresh table is empty and a copy builds states from scratch.
+    const BucketedAcc pristine = accumulator;
+
+    size_t refreshes = 0;
+    for (const auto& fen : test_positions) {
+        board.fen_decode(fen);
+        accumulator.initialise(board);
+        auto initial_white = accumulator.get(WHITE).copy();
+        auto initial_black = accumulator.get(BLACK).copy();
+        for (auto move : board.get_moves()) {
+            const Colour mover = board.who_to_play();
+            board.make_move(move);
+            if (BucketedAcc::needs_refresh(move, mover)) {
+                accumulator.refresh(board, move, mover);
+                refreshes++;
+            } else {
+                accumulator.make_move(move, mover);
+            }
+            BucketedAcc fresh = pristine;
+            fresh.initialise(board);
+            for (Colour c : {WHITE, BLACK}) {
+                EXPECT_EQ(accumulator.get(c), fresh.get(c))
+                    << "Position: " << fen << "\n"
+                    << "Move: " << move.pretty();
+            }
+            board.unmake_move(move);
+            accumulator.unmake_move();
+            EXPECT_EQ(accumulator.get(WHITE), initial_white) << "Position: " << fen << "\nMove: " << move.pretty();
+            EXPECT_EQ(accumulator.get(BLACK), initial_black) << "Position: " << fen << "\nMove: " << move.pretty();
+        }
+    }
+    EXPECT_GT(refreshes, 0);
+}
+
+TEST_F(FixedAccumulatorTest, KingBucketsPerspective) {
+    // Each perspective's half, its own pieces and the other side's, is bucketed by that perspective's king. The two
+    // positions differ only by the white king crossing into another bucket, so only the white half is rebuilt.
+    using BucketedAcc = Accumulator<N_FEATURES, N_ACCUMULATED, ACC_SHIFT, N_KING_BUCKETS>;
+    constexpr size_t In = 2 * BucketedAcc::InputSize;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<nn_t> dist(-0.05, 0.05);
+    std::vector<nn_t> weights(In * N_ACCUMULATED), bias(N_ACCUMULATED);
+    for (auto& w : weights) w = dist(rng);
+    for (auto& b : bias) b = dist(rng);
+    const auto floating = std::make_unique<FloatingAccumulatorLayer<nn_t, BucketedAcc::InputSize, N_ACCUMULATED>>(
+        weights.data(), bias.data());
+    const auto layer = std::make_unique<BucketedAcc::layer_t>(*floating);
+    BucketedAcc accumulator(*floating);
+
+    // Built directly from the board, with the features for both halves in the perspective's bucket.
+    auto expected = [&](const Colour perspective) {
+        auto values = layer->get_bias().copy();
+        const size_t offset = king_bucket(board.find_king(perspective).relative(perspective)) * N_FEATURES;
+        for (Colour c : {perspective, ~perspective}) {
+            for (PieceType p = PAWN; p < N_PIECE; p++) {
+                Bitboard pieces = board.pieces(c, p);
+                while (pieces) {
+                    const size_t half = c == perspective ? 0 : BucketedAcc::InputSize;
+                    layer->add_row(values, half + offset + p * 64 + pop_lsb(&pieces).relative(c), 1);
+                }
+            }
+        }
+        return values;
+    };
+
+    board.fen_decode("4k3/pp3ppp/2n5/8/8/5N2/PP3PPP/3K4 w - - 0 1");
+    accumulator.initialise(board);
+    for (Colour c : {WHITE, BLACK}) {
+        EXPECT_EQ(accumulator.get(c), expected(c));
+    }
+    const auto black_before = accumulator.get(BLACK).copy();
+
+    Move move = board.fetch_move("d1e1");
+    ASSERT_TRUE(BucketedAcc::needs_refresh(move, WHITE));
+    board.make_move(move);
+    accumulator.refresh(board, move, WHITE);
+    for (Colour c : {WHITE, BLACK}) {
+        EXPECT_EQ(accumulator.get(c), expected(c));
+    }
+    // Black's half stays in its bucket, only the white king's feature in it moves.
+    EXPECT_NE(accumulator.get(BLACK), black_before);
+    board.fen_decode("4k3/pp3ppp/2n5/8/8/5N2/PP3PPP/4K3 b - - 1 1");
+    BucketedAcc fresh(*floating);
+    fresh.initialise(board);
+    for (Colour c : {WHITE, BLACK}) {
+        EXPECT_EQ(accumulator.get(c), fresh.get(c));
+    }
+}
+
+TEST_F(FixedAccumulatorTest, RefreshTable) {
+    // Initialising from positions in turn goes through the refresh table, which must agree with building from scratch.
+    const auto pristine = *fixed_accumulator;
+    for (size_t pass = 0; pass < 2; pass++) {
+        for (const auto& fen : test_positions) {
+            board.fen_decode(fen);
+            fixed_accumulator->initialise(board);
+            auto fresh = pristine;
+            fresh.initialise(board);
+            for (Colour c : {WHITE, BLACK}) {
+                EXPECT_EQ(fixed_accumulator->get(c), fresh.get(c)) << "Position: " << fen;
+            }
+        }
+    }
+}
@@ -70,9 +70,18 @@ TEST(LinAlg, SparseVector) {
     EXPECT_FLOAT_EQ(converted[2], 0.0f);
     EXPECT_FLOAT_EQ(converted[3], 4.0f);
     EXPECT_FLOAT_EQ(converted[4], 0.0f);
+
+    // Only the set entries are stored, in the order they were set.
+    EXPECT_EQ(sv.count(), 2);
+    auto as_int = sv.cast_as<int>();
+    std::vector<std::pair<size_t, int>> entries;
+    for (const auto& [index, value] : as_int) {
+        entries.push_back({index, value});
+    }
+    EXPECT_EQ(entries, (std::vector<std::pair<size_t, int>>{{1, 2}, {3, 4}}));
 }
 TEST(LinAlg, MatrixDimensions) {
-    Matrix<float, 2, 3> m;
+    auto m = Matrix<float, 2, 3>::zeros();
     EXPECT_EQ(m.rows(), 2);
     EXPECT_EQ(m.cols(), 3);
 }
@@ -2,6 +2,9 @@
 #include "network.hpp"
 #include "weights.hpp" // Actual weights, generated
 #include "board.hpp"
+#include "netfile.hpp"
+#include <filesystem>
+#include <fstream>
 
 using namespace Neural;
 
@@ -31,6 +34,31 @@ TEST(NeuralNetwork, ReLUBehavior) {
     EXPECT_EQ(output[3], 100);  // Positive passes through
 }
 
+TEST(NeuralNetwork, QuantizedLayerForward) {
+    // Weights and inputs that are exactly representable, so the integer layer must give exactly the float result.
+    constexpr uint8_t weight_shift = 6;
+    LinearLayer<nn_t, 256, 64> layer;
+    for (size_t i = 0; i < 64; i++) {
+        for (size_t j = 0; j < 256; j++) {
+            layer.weight_at(i, j) = std::ldexp(nn_t(rand() % 255 - 127), -weight_shift);
+        }
+        layer.bias_at(i) = std::ldexp(nn_t(rand() % 1000 - 500), -(weight_shift + QUANT_ACT_SHIFT));
+    }
+    Vector<nn_t, 256> input;
+    Vector<uint8_t, 256> quantized_input;
+    for (size_t j = 0; j < 256; j++) {
+        quantized_input[j] = rand() % 128;
+        input[j] = std::ldexp(nn_t(quantized_input[j]), -QUANT_ACT_SHIFT);
+    }
+
+    QuantizedLinearLayer<int8_t, 256, 64> quantized(layer);
+    auto expected = layer.forward(input);
+    auto output = quantized.forward(quantized_input);
+    for (size_t i = 0; i < 64; i++) {
+        EXPECT_EQ(std::ldexp(nn_t(output[i]), -quantized.out_shift()), expected[i]) << "Index: " << i;
+    }
+}
+
 TEST(NeuralNetwork, CanInitializeNetwork) {
     network_t net = Neural::get_network();
 }
@@ -115,4 +143,187 @@ TEST_F(NetworkIntegrationTest, AccumulationCorrectness) {
         }
     }
 
-}
\ No newline at end of file
+}
+TEST_F(NetworkIntegrationTest, LazyAccumulation) {
+    // Moves only reach the accumulator when it's asked for, possibly several plies (and null moves) later, and are only
+    // taken back out if they were ever added.
+    for (const auto& fen : test_positions) {
+        board.fen_decode(fen);
+        auto expect_fresh = [&]() {
+            accumulator.initialise(board);
+            EXPECT_NEAR(network.forward(board.accumulator(), board.who_to_play()),
+                        network.forward(accumulator, board.who_to_play()), 1e-5)
+                << "Position: " << board.fen_encode();
+        };
+        auto moves = board.get_moves();
+        for (auto move : moves) {
+            board.make_move(move);
+            if (board.is_check()) {
+                // Can't pass while in check.
+                board.unmake_move(move);
+                continue;
+            }
+            board.make_nullmove();
+            auto replies = board.get_moves();
+            Move reply = replies[0];
+            // Made and unmade without ever being evaluated.
+            board.make_move(reply);
+            board.unmake_move(reply);
+            board.make_move(reply);
+            expect_fresh();
+            board.unmake_move(reply);
+            board.unmake_nullmove();
+            expect_fresh();
+            board.unmake_move(move);
+        }
+        expect_fresh();
+    }
+}
+
+TEST_F(NetworkIntegrationTest, QuantizedMatchesFloat) {
+    // The quantized network rounds the activations and clips them at 2, so it is only close to the float one. The
+    // output is scaled by LOGISTIC_SCALING for centipawns: on average within 10, never more than 40 off.
+    network_t::quantized_t quantized(network);
+    nn_t total_error = 0;
+    size_t n = 0;
+    for (const auto& fen : test_positions) {
+        board.fen_decode(fen);
+        auto moves = board.get_moves();
+        for (auto move : moves) {
+            board.make_move(move);
+            auto expected = network.forward(board.accumulator(), board.who_to_play());
+            auto score = quantized.forward(board.accumulator(), board.who_to_play());
+            EXPECT_NEAR(score, expected, 40 / LOGISTIC_SCALING)
+                << "Position: " << board.fen_encode() << "\n"
+                << "Float: " << expected << "\n"
+                << "Quantized: " << score;
+            total_error += std::abs(score - expected);
+            n++;
+            board.unmake_move(move);
+        }
+    }
+    EXPECT_LT(total_error / n, 10 / LOGISTIC_SCALING);
+}
+
+TEST_F(NetworkIntegrationTest, OutputBuckets) {
+    // Each bucket's output layer gives the same evaluation as an unbucketed network built with it.
+    using bucketed_t = BucketedNetwork<N_FEATURES, N_ACCUMULATED, ACC_SHIFT, PieceCountBuckets<2>, 64, 1>;
+    static_assert(!bucketed_t::bucketed(0) && bucketed_t::bucketed(1));
+    auto other = std::make_unique<LinearLayer<nn_t, 64, 1>>(network.layer<1>());
+    other->bias_at(0) += 0.5;
+    network_t other_network;
+    other_network.set_layer<0>(std::make_unique<LinearLayer<nn_t, 256, 64>>(network.layer<0>()));
+    other_network.set_layer<1>(std::make_unique<LinearLayer<nn_t, 64, 1>>(*other));
+    bucketed_t bucketed;
+    bucketed.set_layer<0>(std::make_unique<LinearLayer<nn_t, 256, 64>>(network.layer<0>()));
+    bucketed.set_layer<1>(0, std::make_unique<LinearLayer<nn_t, 64, 1>>(network.layer<1>()));
+    bucketed.set_layer<1>(1, std::move(other));
+
+    bucketed_t::quantized_t quantized(bucketed);
+    network_t::quantized_t quantized_network(network);
+    network_t::quantized_t quantized_other(other_network);
+    for (const auto& fen : test_positions) {
+        board.fen_decode(fen);
+        accumulator.initialise(board);
+        EXPECT_EQ(bucketed.forward(accumulator, WHITE, 0), network.forward(accumulator, WHITE));
+        EXPECT_EQ(bucketed.forward(accumulator, WHITE, 1), other_network.forward(accumulator, WHITE));
+        EXPECT_EQ(quantized.forward(accumulator, WHITE, 0), quantized_network.forward(accumulator, WHITE));
+        EXPECT_EQ(quantized.forward(accumulator, WHITE, 1), quantized_other.forward(accumulator, WHITE));
+    }
+}
+
+TEST(NeuralNetwork, OutputBucketSelection) {
+    Board board;
+    board.fen_decode("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    EXPECT_EQ(PieceCountBuckets<1>::bucket(board), 0);
+    EXPECT_EQ(PieceCountBuckets<8>::bucket(board), 7);
+    EXPECT_EQ(PhaseMaterialBuckets<4>::bucket(board), 3);
+    board.fen_decode("8/8/4k3/8/3R4/3K4/8/8 w - - 0 1");
+    EXPECT_EQ(PieceCountBuckets<8>::bucket(board), 0);
+    EXPECT_EQ(PhaseMaterialBuckets<4>::bucket(board), 0);
+    board.fen_decode("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    EXPECT_EQ(PieceCountBuckets<8>::bucket(board), 7);
+}
+
+TEST(NetFile, RoundTrip) {
+    // Loading the compiled in network from a file gives exactly the same evaluations.
+    const std::string path = ::testing::TempDir() + "admete_roundtrip.net";
+    ASSERT_TRUE(Neural::save_network(path));
+    ASSERT_TRUE(Neural::load_network(path));
+    network_t::quantized_t compiled(Neural::get_network());
+    accumulator_t accumulator = Neural::get_accumulator();
+    for (const std::string fen : {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                                  "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"}) {
+        Board board;
+        board.fen_decode(fen);
+        accumulator.initialise(board);
+        for (Colour c : {WHITE, BLACK}) {
+            EXPECT_EQ(board.accumulator().get(c), accumulator.get(c)) << "Position: " << fen;
+            EXPECT_EQ(Neural::current_network().forward(board.accumulator(), c), compiled.forward(accumulator, c))
+                << "Position: " << fen;
+        }
+    }
+    Neural::reset_network();
+    std::filesystem::remove(path);
+}
+
+TEST(NetFile, RejectsBadFiles) {
+    const auto *before = &Neural::current_network();
+    EXPECT_FALSE(Neural::load_network(::testing::TempDir() + "admete_missing.net"));
+
+    const std::string path = ::testing::TempDir() + "admete_bad.net";
+    ASSERT_TRUE(Neural::save_network(path));
+    const auto size = std::filesystem::file_size(path);
+    // Truncated.
+    std::filesystem::resize_file(path, size - sizeof(float));
+    EXPECT_FALSE(Neural::load_network(path));
+    // Wrong magic number.
+    std::filesystem::resize_file(path, size);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.write("NOTANET!", 8);
+    }
+    EXPECT_FALSE(Neural::load_network(path));
+    // Failed loads keep the current network.
+    EXPECT_EQ(&Neural::current_network(), before);
+    std::filesystem::remove(path);
+}
+
+TEST(NetFile, ReloadKeepsHistory) {
+    // Switching networks mid-game keeps the moves played, so repetitions are still seen, and the accumulator can still
+    // unmake them.
+    const std::string path = ::testing::TempDir() + "admete_reload.net";
+    ASSERT_TRUE(Neural::save_network(path));
+    Board board;
+    board.initialise_starting_position();
+    std::vector<Move> moves;
+    for (const std::string uci : {"e2e4", "e7e5", "e1e2", "e8e7", "g1f3", "g8f6", "f3g1", "f6g8", "g1f3"}) {
+        moves.push_back(board.fetch_move(uci));
+        ASSERT_NE(moves.back(), NULL_MOVE) << uci;
+        board.make_move(moves.back());
+    }
+    const zobrist_t hash = board.hash();
+    const ply_t repetitions = board.repetitions(0);
+    ASSERT_EQ(repetitions, 1);
+
+    ASSERT_TRUE(Neural::load_network(path));
+    board.reload_network();
+    EXPECT_EQ(board.ply(), moves.size());
+    EXPECT_EQ(board.hash(), hash);
+    EXPECT_EQ(board.repetitions(0), repetitions);
+    accumulator_t fresh = Neural::current_accumulator();
+    fresh.initialise(board);
+    for (Colour c : {WHITE, BLACK}) {
+        EXPECT_EQ(board.accumulator().get(c), fresh.get(c));
+    }
+
+    for (auto it = moves.rbegin(); it != moves.rend(); it++) {
+        board.unmake_move(*it);
+    }
+    fresh.initialise(board);
+    for (Colour c : {WHITE, BLACK}) {
+        EXPECT_EQ(board.accumulator().get(c), fresh.get(c));
+    }
+    Neural::reset_network();
+    std::filesystem::remove(path);
+}
@@ -134,4 +134,72 @@ TEST(Ordering, NewSEE) {
     EXPECT_TRUE(SEE::see(board, move, score));
     EXPECT_FALSE(SEE::see(board, move, score + 1));
   }
-}
\ No newline at end of file
+}
+TEST(Ordering, MovePicker) {
+  // The picker should hand out every legal move exactly once, apart from the hash move.
+  std::tuple<std::string, std::string> testcases[] = {
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "e2e4"},
+      {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e5f7"},
+      {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e1g1"},
+      {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", "b4f4"},
+      {"4k3/8/8/8/4Pp2/8/8/4K3 b - e3 0 1", "f4e3"},
+      {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", "d2d4"},
+      {"4k3/8/8/8/8/8/4r3/4K3 w - - 0 1", "e1e2"},
+  };
+  Board board = Board();
+
+  for (const auto &[fen, hash_string] : testcases) {
+    board.fen_decode(fen);
+    const MoveList legal_moves = board.get_moves();
+    const Move hash_move = board.fetch_move(hash_string);
+    ASSERT_NE(hash_move, NULL_MOVE);
+
+    Ordering::MovePicker picker(board, NULL_KROW);
+    EXPECT_FALSE(picker.is_mate());
+    EXPECT_EQ(picker.hash_move(pack_move(hash_move)), hash_move);
+    MoveList picked = {hash_move};
+    for (Move move = picker.next(); move != NULL_MOVE; move = picker.next()) {
+      EXPECT_NE(move, hash_move) << fen;
+      EXPECT_FALSE(is_legal(move, picked)) << fen << " " << move.pretty();
+      picked.push_back(move);
+    }
+    EXPECT_EQ(picked.size(), legal_moves.size()) << fen;
+    for (const Move move : legal_moves) {
+      EXPECT_TRUE(is_legal(move, picked)) << fen << " " << move.pretty();
+    }
+  }
+}
+
+TEST(Ordering, MovePickerHashMove) {
+  Board board = Board();
+  // A hash move that isn't legal here is ignored.
+  board.fen_decode("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+  Ordering::MovePicker picker(board, NULL_KROW);
+  EXPECT_EQ(picker.hash_move(DenseMove(Square(RANK1, FILEE), Square(RANK3, FILEE))), NULL_MOVE);
+
+  // Checkmate is spotted straight away.
+  board.fen_decode("rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3");
+  EXPECT_TRUE(Ordering::MovePicker(board, NULL_KROW).is_mate());
+
+  // Winning captures come before quiet moves.
+  board.fen_decode("4k3/8/8/3p4/8/8/3Q4/4K1N1 w - - 0 1");
+  Ordering::MovePicker ordered(board, NULL_KROW);
+  const Move first = ordered.next();
+  EXPECT_TRUE(first.is_capture());
+  EXPECT_EQ(first.target, Square(RANK5, FILED));
+}
+
+TEST(Ordering, MovePickerHasMoves) {
+  Board board = Board();
+  // A boxed in king still has moves.
+  board.fen_decode("r1bq1rk1/pppp1ppp/2n2n2/2b1p3/2B1P3/2N2N2/PPPP1PPP/R1BQ1RK1 w - - 0 1");
+  EXPECT_TRUE(Ordering::MovePicker(board, NULL_KROW).has_moves());
+  board.fen_decode("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+  EXPECT_FALSE(Ordering::MovePicker(board, NULL_KROW).has_moves());
+  // Only a pawn can move.
+  board.fen_decode("7k/5Q2/6K1/8/8/p7/8/8 b - - 0 1");
+  EXPECT_TRUE(Ordering::MovePicker(board, NULL_KROW).has_moves());
+  // Checkmate.
+  board.fen_decode("rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3");
+  EXPECT_FALSE(Ordering::MovePicker(board, NULL_KROW).has_moves());
+}
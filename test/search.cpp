@@ -1,6 +1,8 @@
 #include "search.hpp"
 #include "board.hpp"
 #include "evaluate.hpp"
+#include <climits>
+#include <random>
 #include <gtest/gtest.h>
 
 TEST(Search, MateInTwo) {
@@ -104,7 +106,7 @@ TEST(Search, InsufficientMaterial) {
   PrincipleLine line;
   line.reserve(depth);
 
-  for (const std::string fen : fens) {
+  for (const std::string &fen : fens) {
     board.fen_decode(fen);
     EXPECT_EQ(Search::search(board, depth, line),
               Evaluation::drawn_score(board));
@@ -134,10 +136,102 @@ TEST(Search, Stalemate) {
   }
 }
 
+TEST(Search, StalemateBeforePruning) {
+  // Stalemate is found before the static eval, which is far above beta, could prune the node.
+  Board board = Board();
+  board.fen_decode("k7/2Q5/8/1K6/8/8/7Q/3RR1Q1 b - - 0 1");
+  ASSERT_FALSE(board.is_endgame());
+  const score_t draw_score = Evaluation::drawn_score(board);
+  const score_t alpha = Evaluation::eval(board) - 1000;
+  Search::SearchStack stack;
+  Search::SearchOptions options;
+  Search::SearchStackEntry *ss = stack.data() + Search::search_stack_offset;
+  for (depth_t depth = 0; depth <= 4; depth++) {
+    EXPECT_EQ(Search::scout_search(board, depth, alpha, UINT_MAX, false, true, CUTNODE, ss, options), draw_score);
+    EXPECT_EQ(Search::pv_search(board, depth, alpha, alpha + 2000, UINT_MAX, false, ss, options), draw_score);
+  }
+}
+
+// Play quiet moves, that don't give check, from the starting position until the board is `ply` plies in. Pawn moves
+// come often enough to keep clear of the 50 move rule, and one comes last, so that the final position is new.
+static void play_to_ply(Board &board, const ply_t ply) {
+  board.initialise_starting_position();
+  std::mt19937 rng(1);
+  while (board.ply() < ply) {
+    const bool pawn_move = board.halfmove_clock() >= 40 || board.ply() == ply - 1;
+    MoveList quiet, preferred;
+    for (const Move move : board.get_moves()) {
+      if (move.is_capture() || move.is_promotion() || board.gives_check(move)) {
+        continue;
+      }
+      quiet.push_back(move);
+      if ((move.moving_piece == PAWN) == pawn_move) {
+        preferred.push_back(move);
+      }
+    }
+    const MoveList &candidates = preferred.empty() ? quiet : preferred;
+    ASSERT_FALSE(candidates.empty()) << board.fen_encode();
+    Move move = candidates[rng() % candidates.size()];
+    board.make_move(move);
+  }
+}
+
+TEST(Search, MaxPly) {
+  // At the last ply the board has room for, every search stops at the static eval instead of making another move.
+  Board board = Board();
+  play_to_ply(board, MAX_PLY - 1);
+  ASSERT_FALSE(board.is_draw());
+  ASSERT_FALSE(board.is_check());
+  const score_t eval = Evaluation::eval(board);
+  Search::SearchStack stack;
+  Search::SearchOptions options;
+  Search::SearchStackEntry *ss = stack.data() + Search::search_stack_offset;
+  EXPECT_EQ(Search::quiesce(board, MIN_SCORE, MAX_SCORE, ss, options), eval);
+  EXPECT_EQ(Search::scout_search(board, 4, eval - 1, UINT_MAX, false, true, CUTNODE, ss, options), eval);
+  EXPECT_EQ(Search::pv_search(board, 4, MIN_SCORE, MAX_SCORE, UINT_MAX, false, ss, options), eval);
+  EXPECT_EQ(options.get_nodes(), 0);
+}
+
+TEST(Search, SearchStack) {
+  // Each node leaves its static eval in its own stack entry, and the quiescence search below it uses the next ones.
+  Board board = Board();
+  board.fen_decode("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10");
+  Search::SearchStack stack;
+  Search::SearchOptions options;
+  Search::SearchStackEntry *ss = stack.data() + Search::search_stack_offset;
+  const score_t eval = Evaluation::eval(board);
+  Search::scout_search(board, 3, eval, UINT_MAX, false, true, CUTNODE, ss, options);
+  EXPECT_EQ(ss->static_eval, eval);
+  EXPECT_NE(ss[1].static_eval, MIN_SCORE);
+  Search::quiesce(board, MIN_SCORE, MAX_SCORE, ss, options);
+  EXPECT_EQ(ss->static_eval, eval);
+  // PV nodes never need it, and don't make null moves.
+  Search::pv_search(board, 3, MIN_SCORE, MAX_SCORE, UINT_MAX, false, ss, options);
+  EXPECT_EQ(ss->static_eval, MIN_SCORE);
+  EXPECT_NE(ss->move, NULL_MOVE);
+  EXPECT_EQ(ss->reduction, 0);
+}
+
+TEST(Search, NodeLimitThreads) {
+  // The node limit covers the helper threads' nodes as well as the main thread's.
+  const unsigned old_threads = Search::n_threads;
+  Search::n_threads = 3;
+  Board board = Board();
+  board.fen_decode("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10");
+  Search::SearchOptions options;
+  options.max_nodes = 100000;
+  PrincipleLine line;
+  Search::search(board, MAX_DEPTH - 1, POS_INF, POS_INF, line, options);
+  Search::n_threads = old_threads;
+  EXPECT_GE(options.get_nodes(), options.max_nodes);
+  // The threads can overrun by the nodes they haven't added to the shared count yet, and by the quiescence nodes they
+  // finish once the limit is hit, but nothing like a limit each.
+  EXPECT_LT(options.get_nodes(), options.max_nodes * 11 / 10);
+}
+
 TEST(Search, Underpromotion) {
   Board board = Board();
   board.set_root();
-  const score_t draw_score = Evaluation::drawn_score(board);
   std::pair<std::string, score_t> testcases[] = {
       {"6n1/5P1k/5Q2/8/8/8/8/7K w - - 0 1", MATING_SCORE - 1},
       {"7k/8/8/8/8/5q2/5p1K/6N1 b - - 0 1", MATING_SCORE - 1},
@@ -156,7 +250,6 @@ TEST(Search, Underpromotion) {
 TEST(Search, Rule50CheckmatePriority) {
   Board board = Board();
   board.set_root();
-  const score_t draw_score = Evaluation::drawn_score(board);
   std::pair<std::string, score_t> testcases[] = {
       {"7k/1R6/R7/8/8/8/8/4K3 w - - 99 1", MATING_SCORE - 1},
       {"4k3/8/8/8/8/r7/1r6/7K b - - 99 1", MATING_SCORE - 1},
@@ -170,4 +263,52 @@ TEST(Search, Rule50CheckmatePriority) {
     board.fen_decode(fen);
     EXPECT_EQ(Search::search(board, depth, line), score);
   }
-}
\ No newline at end of file
+}
+TEST(Search, PrincipleLine) {
+  // The line should be playable from the root, and end in mate for a forced mate.
+  std::pair<std::string, size_t> testcases[] = {
+      {"r2q1b1r/1pN1n1pp/p1n3k1/4Pb2/2BP4/8/PPP3PP/R1BQ1RK1 w - - 1 0", 3},
+      {"r1b1kb1r/pppp1ppp/5q2/4n3/3KP3/2N3PN/PPP4P/R1BQ1B1R b kq - 0 1", 5},
+  };
+  Board board = Board();
+  constexpr depth_t depth = 8;
+  PrincipleLine line;
+
+  for (const auto &[fen, length] : testcases) {
+    board.fen_decode(fen);
+    Search::search(board, depth, line);
+    ASSERT_EQ(line.size(), length) << fen;
+    for (Move move : line) {
+      ASSERT_TRUE(is_legal(move, board.get_moves())) << fen << " " << move.pretty();
+      board.make_move(move);
+    }
+    EXPECT_TRUE(board.is_check());
+    EXPECT_TRUE(board.get_moves().empty());
+  }
+}
+
+TEST(Search, Killers) {
+  Search::SearchStackEntry entry;
+  const Move a = Move(KNIGHT, Square(RANK1, FILEB), Square(RANK3, FILEC));
+  const Move b = Move(KNIGHT, Square(RANK1, FILEG), Square(RANK3, FILEF));
+  const Move c = Move(PAWN, Square(RANK2, FILEE), Square(RANK3, FILEE));
+  const Move d = Move(PAWN, Square(RANK2, FILED), Square(RANK3, FILED));
+  const Move capture = Move(QUEEN, Square(RANK1, FILED), Square(RANK7, FILED), CAPTURE);
+
+  // Captures aren't killers, and a killer is only kept once.
+  entry.store_killer(capture);
+  entry.store_killer(a);
+  entry.store_killer(a);
+  EXPECT_TRUE(a == entry.killers);
+  EXPECT_FALSE(capture == entry.killers);
+  EXPECT_EQ(entry.killer_index, 1);
+
+  // Once the row is full, the oldest killer is replaced.
+  entry.store_killer(b);
+  entry.store_killer(c);
+  entry.store_killer(d);
+  EXPECT_FALSE(a == entry.killers);
+  EXPECT_TRUE(b == entry.killers);
+  EXPECT_TRUE(c == entry.killers);
+  EXPECT_TRUE(d == entry.killers);
+}
@@ -0,0 +1,178 @@
+#include "transposition.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <random>
+#include <thread>
+
+TEST(Transposition, StoreProbe) {
+  Cache::TranspositionTable table = Cache::TranspositionTable();
+  const zobrist_t hash = 0x123456789abcdef0;
+  const Move move = Move(KNIGHT, Square(RANK1, FILEB), Square(RANK3, FILEC));
+  table.store(hash, -123, Bounds::LOWER, 7, move, 0);
+
+  Cache::TransElement hit;
+  ASSERT_TRUE(table.probe(hash, hit));
+  EXPECT_EQ(hit.hash(), hash);
+  EXPECT_EQ(hit.eval(0), -123);
+  EXPECT_EQ(hit.depth(), 7);
+  EXPECT_TRUE(hit.lower());
+  EXPECT_EQ(hit.move(), move);
+  EXPECT_FALSE(hit.has_static_eval());
+
+  EXPECT_FALSE(table.probe(hash ^ 1, hit));
+
+  // The static eval goes in the spare bits of the data word, and survives a later store without one.
+  table.store(hash, 50, Bounds::EXACT, 8, move, 0, -77);
+  ASSERT_TRUE(table.probe(hash, hit));
+  EXPECT_EQ(hit.static_eval(), -77);
+  EXPECT_EQ(hit.eval(0), 50);
+  EXPECT_EQ(hit.move(), move);
+  table.store(hash, 60, Bounds::EXACT, 9, move, 0);
+  ASSERT_TRUE(table.probe(hash, hit));
+  EXPECT_EQ(hit.eval(0), 60);
+  EXPECT_EQ(hit.static_eval(), -77);
+}
+
+TEST(Transposition, MateScores) {
+  Cache::TranspositionTable table = Cache::TranspositionTable();
+  const zobrist_t hash = 0xfedcba9876543210;
+  // Mate scores are stored relative to the node, and come back relative to the root at the new ply.
+  table.store(hash, MATING_SCORE - 5, Bounds::EXACT, 3, NULL_MOVE, 2);
+  Cache::TransElement hit;
+  ASSERT_TRUE(table.probe(hash, hit));
+  EXPECT_EQ(hit.eval(4), MATING_SCORE - 7);
+  EXPECT_TRUE(hit.exact());
+}
+
+TEST(Transposition, Aging) {
+  Cache::TranspositionTable table = Cache::TranspositionTable();
+  // Hashes that share a bucket.
+  auto hash = [](int i) { return ((zobrist_t)i << 40) | 0x3; };
+  for (int i = 0; i < 4; i++) {
+    table.store(hash(i), 0, Bounds::EXACT, 10, NULL_MOVE, 0);
+  }
+  table.new_search();
+  table.new_search();
+  // Refresh all but the last entry, which is now two searches old.
+  for (int i = 0; i < 3; i++) {
+    table.store(hash(i), 0, Bounds::EXACT, 10, NULL_MOVE, 0);
+  }
+  // A shallow entry should replace the stale one, even though it is deeper.
+  table.store(hash(4), 0, Bounds::EXACT, 1, NULL_MOVE, 0);
+  Cache::TransElement hit;
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(table.probe(hash(i), hit));
+  }
+  EXPECT_FALSE(table.probe(hash(3), hit));
+  EXPECT_TRUE(table.probe(hash(4), hit));
+}
+
+TEST(Transposition, Snapshot) {
+  const size_t old_tt_max = Cache::tt_max;
+  Cache::tt_max = 1 << 12;
+  Cache::TranspositionTable table = Cache::TranspositionTable();
+  Cache::tt_max = old_tt_max;
+
+  const Move move = Move(QUEEN, Square(RANK1, FILED), Square(RANK5, FILEH));
+  for (zobrist_t hash = 1; hash < 100; hash++) {
+    table.store(hash * 0x9e3779b97f4a7c15, hash, Bounds::UPPER, hash % 20, move, 0);
+  }
+  const std::string path = (std::filesystem::temp_directory_path() / "admete_tt_snapshot.bin").string();
+  ASSERT_TRUE(table.save(path));
+
+  // Loading takes the size from the snapshot.
+  Cache::TranspositionTable loaded = Cache::TranspositionTable();
+  ASSERT_TRUE(loaded.load(path));
+  EXPECT_EQ(loaded.size(), table.size());
+  for (zobrist_t hash = 1; hash < 100; hash++) {
+    Cache::TransElement hit;
+    ASSERT_TRUE(loaded.probe(hash * 0x9e3779b97f4a7c15, hit));
+    EXPECT_EQ(hit.eval(0), (score_t)hash);
+    EXPECT_EQ(hit.depth(), (depth_t)(hash % 20));
+    EXPECT_TRUE(hit.upper());
+    EXPECT_EQ(hit.move(), move);
+  }
+  // Saving the same table again gives the same bytes.
+  const std::string again = path + ".2";
+  ASSERT_TRUE(loaded.save(again));
+  std::ifstream first(path, std::ios::binary), second(again, std::ios::binary);
+  EXPECT_TRUE(std::equal(std::istreambuf_iterator<char>(first), std::istreambuf_iterator<char>(),
+                         std::istreambuf_iterator<char>(second), std::istreambuf_iterator<char>()));
+  std::filesystem::remove(again);
+  // The loaded table is still writable.
+  loaded.store(1, 0, Bounds::EXACT, 1, NULL_MOVE, 0);
+  std::filesystem::remove(path);
+
+  EXPECT_FALSE(loaded.load(path));
+}
+
+TEST(Transposition, Concurrent) {
+  // Hammer a small table from several threads. Every entry stored is derived from its hash, so any entry that
+  // comes back with a mismatched body must have been torn between two stores.
+  const size_t old_tt_max = Cache::tt_max;
+  Cache::tt_max = 1 << 8;
+  Cache::TranspositionTable table = Cache::TranspositionTable();
+  Cache::tt_max = old_tt_max;
+
+  constexpr int n_threads = 4;
+  constexpr int n_iterations = 200000;
+  std::atomic<int> bad = 0;
+  std::atomic<int> hits = 0;
+  auto work = [&](unsigned seed) {
+    std::mt19937_64 rng(seed);
+    for (int i = 0; i < n_iterations; i++) {
+      const uint64_t k = rng() & 0xfff;
+      const zobrist_t hash = k * 0x9e3779b97f4a7c15;
+      const score_t score = k & 0x3ff;
+      const depth_t depth = (k >> 6) & 0x3f;
+      const Move move = Move(PAWN, Square(k & 0x3f), Square((k >> 6) & 0x3f));
+      if (i % 2) {
+        table.store(hash, score, Bounds::EXACT, depth, move, 0);
+      } else {
+        Cache::TransElement hit;
+        if (table.probe(hash, hit)) {
+          hits++;
+          if (hit.eval(0) != score || hit.depth() != depth || !(hit.move() == move)) {
+            bad++;
+          }
+        }
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < n_threads; i++) {
+    threads.emplace_back(work, i);
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  EXPECT_GT(hits, 0);
+  EXPECT_EQ(bad, 0);
+}
+
+TEST(Transposition, EvalCache) {
+  Cache::EvalCache cache = Cache::EvalCache();
+  const zobrist_t hash = 0x0123456789abcdef;
+  // A hash with the same index but a different key.
+  const zobrist_t other = hash ^ (zobrist_t(1) << 40);
+  score_t eval;
+  EXPECT_FALSE(cache.probe(hash, eval));
+
+  cache.store(hash, -321);
+  ASSERT_TRUE(cache.probe(hash, eval));
+  EXPECT_EQ(eval, -321);
+  EXPECT_FALSE(cache.probe(other, eval));
+
+  cache.store(other, 456);
+  ASSERT_TRUE(cache.probe(other, eval));
+  EXPECT_EQ(eval, 456);
+  EXPECT_FALSE(cache.probe(hash, eval));
+
+  EXPECT_EQ(cache.probes(), 5);
+  EXPECT_EQ(cache.hits(), 2);
+  cache.clear();
+  EXPECT_FALSE(cache.probe(other, eval));
+}